@@ -63,6 +63,7 @@ echo ===============================
 echo 操作提示：
 echo 1. 在打开的 Visual Studio 中，右键将 FinalProject 设置为启动项目
 echo 2. 点击 "本地 Windows 调试器" 或按 F5 运行
+echo 3. 首次运行或改动场景/灯光后，在调试命令参数里加 --bake 运行一次，烘焙探针和光照贴图
 echo ===============================
 echo.
 
@@ -0,0 +1,46 @@
+#version 330 core
+out vec3 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D sourceTexture;
+uniform vec2 sourceTexel;   // 1 / 源纹理尺寸
+uniform bool firstLevel;    // 从全分辨率场景颜色降到第一级
+
+float karisWeight(vec3 c)
+{
+    return 1.0 / (1.0 + dot(c, vec3(0.2126, 0.7152, 0.0722)));
+}
+
+// 泛光降采样：13 次双线性采样组成 5 个 2x2 块（中心块权重 0.5，四角块各 0.125），比直接 2x2 平均少闪烁
+// 第一级每块按 1 / (1 + 亮度) 加权（Karis 平均），单个极亮像素不会扩散成闪烁的光斑
+void main()
+{
+    vec2 t = sourceTexel;
+    vec3 a = texture(sourceTexture, TexCoords + t * vec2(-2.0,  2.0)).rgb;
+    vec3 b = texture(sourceTexture, TexCoords + t * vec2( 0.0,  2.0)).rgb;
+    vec3 c = texture(sourceTexture, TexCoords + t * vec2( 2.0,  2.0)).rgb;
+    vec3 d = texture(sourceTexture, TexCoords + t * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(sourceTexture, TexCoords).rgb;
+    vec3 f = texture(sourceTexture, TexCoords + t * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(sourceTexture, TexCoords + t * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(sourceTexture, TexCoords + t * vec2( 0.0, -2.0)).rgb;
+    vec3 i = texture(sourceTexture, TexCoords + t * vec2( 2.0, -2.0)).rgb;
+    vec3 j = texture(sourceTexture, TexCoords + t * vec2(-1.0,  1.0)).rgb;
+    vec3 k = texture(sourceTexture, TexCoords + t * vec2( 1.0,  1.0)).rgb;
+    vec3 l = texture(sourceTexture, TexCoords + t * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(sourceTexture, TexCoords + t * vec2( 1.0, -1.0)).rgb;
+
+    vec3 blocks[5] = vec3[5]((j + k + l + m) * 0.25, (a + b + d + e) * 0.25, (b + c + e + f) * 0.25,
+                             (d + e + g + h) * 0.25, (e + f + h + i) * 0.25);
+    float weights[5] = float[5](0.5, 0.125, 0.125, 0.125, 0.125);
+
+    vec3 color = vec3(0.0);
+    float total = 0.0;
+    for (int n = 0; n < 5; ++n)
+    {
+        float w = firstLevel ? weights[n] * karisWeight(blocks[n]) : weights[n];
+        color += blocks[n] * w;
+        total += w;
+    }
+    FragColor = max(color / total, vec3(0.0));
+}
@@ -0,0 +1,18 @@
+#version 330 core
+out vec3 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D sourceTexture; // 低一级（更小）的泛光纹理
+uniform vec2 sourceTexel;
+
+// 泛光上采样：3x3 帐篷滤波，结果以加法混合叠到高一级上，逐级累积出大半径的柔和光晕
+void main()
+{
+    vec2 t = sourceTexel;
+    vec3 color = texture(sourceTexture, TexCoords).rgb * 4.0;
+    color += (texture(sourceTexture, TexCoords + vec2(-t.x, 0.0)).rgb + texture(sourceTexture, TexCoords + vec2(t.x, 0.0)).rgb
+            + texture(sourceTexture, TexCoords + vec2(0.0, -t.y)).rgb + texture(sourceTexture, TexCoords + vec2(0.0, t.y)).rgb) * 2.0;
+    color += texture(sourceTexture, TexCoords - t).rgb + texture(sourceTexture, TexCoords + t).rgb
+           + texture(sourceTexture, TexCoords + vec2(-t.x, t.y)).rgb + texture(sourceTexture, TexCoords + vec2(t.x, -t.y)).rgb;
+    FragColor = color / 16.0;
+}
@@ -0,0 +1,65 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+
+uniform vec3 camPos;
+
+#include "pbr_lighting.glsl"
+#include "gbuffer.glsl"
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gMaterial;
+uniform sampler2D gEmissive;
+uniform sampler2D gDepth;
+uniform mat4 invViewProjection;
+
+// 延迟渲染的光照通道：每个屏幕像素只算一次光照和阴影，与不透明物体数量和重叠层数无关
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth >= 1.0) discard; // 背景留给天空盒
+
+    vec4 albedoData = texelFetch(gAlbedo, pixel, 0);
+    vec4 material = texelFetch(gMaterial, pixel, 0);
+    vec3 albedo = pow(albedoData.rgb, vec3(2.2));
+    float metallic = material.r;
+    float roughness = material.g;
+    float ao = material.b;
+    vec3 N = octDecode(texelFetch(gNormal, pixel, 0).rg);
+    vec3 emissive = texelFetch(gEmissive, pixel, 0).rgb;
+
+    // 由深度重建世界坐标
+    vec4 clipPos = vec4(TexCoords * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProjection * clipPos;
+    vec3 WorldPos = worldPos.xyz / worldPos.w;
+
+    vec3 V = normalize(camPos - WorldPos);
+    vec3 F0 = mix(vec3(0.04), albedo, metallic);
+
+    int flags = decodeMaterialFlags(material.a);
+    bool lightmapped = (flags & GBUFFER_FLAG_LIGHTMAP) != 0; // 自发光通道里存的是烘焙辐照度
+
+    vec3 Lo = vec3(0.0);
+    vec3 ambient;
+    if (lightmapped)
+    {
+        // 烘焙辐照度只替换漫反射项，镜面 IBL 和反射探针照常计算
+        ambient = ambientFromIrradiance(WorldPos, N, V, albedo, metallic, roughness, ao, F0, albedoData.a > 0.5, emissive);
+        emissive = vec3(0.0);
+    }
+    else
+    {
+        int cluster = clusterIndex(gl_FragCoord.xy, depth);
+        Lo = pointLighting(cluster, WorldPos, N, V, albedo, metallic, roughness, F0, (flags & GBUFFER_FLAG_POM) != 0, false);
+        ambient = ambientLighting(WorldPos, N, V, albedo, metallic, roughness, ao, F0, albedoData.a > 0.5);
+    }
+    if (dirLight.enabled)
+        Lo += dirLightCalculate(WorldPos, N, V, albedo, F0, roughness, metallic, 1.0, false);
+
+    vec3 color = ambient + Lo + emissive;
+
+    FragColor = vec4(color, 1.0);
+    gl_FragDepth = depth; // 写回深度，供天空盒、替身和透明通道做深度测试
+}
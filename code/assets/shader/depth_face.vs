@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 4) in mat4 instanceMatrix;
+
+uniform bool useInstance;
+uniform mat4 model;
+uniform mat4 shadowMatrix; // 当前立方体面的投影 * 视图矩阵
+
+out vec4 FragPos; // 世界坐标，depth.fs 用它计算到光源的线性距离
+
+// 逐面阴影渲染：每次只画立方体的一个面，不需要几何着色器复制三角形
+void main()
+{
+    FragPos = useInstance ? instanceMatrix * vec4(aPos, 1.0) : model * vec4(aPos, 1.0);
+    gl_Position = shadowMatrix * FragPos;
+}
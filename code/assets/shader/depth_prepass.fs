@@ -0,0 +1,5 @@
+#version 330 core
+// 深度预通道只写深度，颜色写入在 CPU 端用 glColorMask 关闭
+void main()
+{
+}
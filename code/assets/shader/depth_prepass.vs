@@ -0,0 +1,26 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+// 实例化数据：占用 location 4, 5, 6, 7（与 pbr.vs 一致）
+layout (location = 4) in mat4 instanceMatrix;
+
+// 位置计算必须与 pbr.vs 完全相同，两边都声明 invariant，GL_EQUAL 才不会因精度差异丢像素
+invariant gl_Position;
+
+uniform bool useInstance;
+uniform mat4 model;
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    if(useInstance)
+    {
+        vec3 WorldPos = vec3(instanceMatrix * vec4(aPos, 1.0));
+        gl_Position = projection * view * vec4(WorldPos, 1.0);
+    }
+    else
+    {
+        vec3 WorldPos = vec3(model * vec4(aPos, 1.0));
+        gl_Position = projection * view * vec4(WorldPos, 1.0);
+    }
+}
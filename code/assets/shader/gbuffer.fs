@@ -0,0 +1,36 @@
+#version 330 core
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec2 gNormal;
+layout (location = 2) out vec4 gMaterial;
+layout (location = 3) out vec3 gEmissive;
+in vec2 TexCoords;
+in vec3 WorldPos;
+in vec3 Normal;
+in mat3 TBN;
+in vec3 TangentViewPos;
+in vec3 TangentFragPos;
+
+uniform vec3 camPos;
+uniform bool useIBL;
+
+#include "pbr_material.glsl"
+#include "gbuffer.glsl"
+#include "lightmap.glsl"
+
+// 延迟渲染的几何通道：与 pbr.fs 采样同样的材质，只写表面属性，不做光照
+void main()
+{
+    SurfaceData surface = sampleSurface();
+
+    vec3 N = surface.N;
+    if (doubleSided && dot(N, camPos - WorldPos) < 0.0) N = -N;
+
+    gAlbedo = vec4(pow(surface.albedo, vec3(1.0/2.2)), useIBL ? 1.0 : 0.0);
+    gNormal = octEncode(N);
+    // 有光照贴图的面借自发光通道存烘焙辐照度（这些面本身不发光），光照通道用它代替漫反射环境光并跳过点光源
+    vec3 baked;
+    bool lightmapped = sampleLightmap(baked);
+    int flags = (usePOM ? GBUFFER_FLAG_POM : 0) | (lightmapped ? GBUFFER_FLAG_LIGHTMAP : 0);
+    gMaterial = vec4(surface.metallic, surface.roughness, surface.ao, encodeMaterialFlags(flags));
+    gEmissive = lightmapped ? baked : surface.emissive;
+}
@@ -0,0 +1,43 @@
+// 延迟渲染 G-buffer 布局，gbuffer.fs 写入，deferred_lighting.fs 读取
+//   gAlbedo   (RGBA8)          : rgb 基础色（gamma 编码以保留暗部精度），a 是否使用 IBL
+//   gNormal   (RG16)           : 八面体编码的世界空间法线
+//   gMaterial (RGBA8)          : r 金属度, g 粗糙度, b AO, a 标志位 / 3（bit 0 视差表面（阴影偏移），bit 1 有光照贴图）
+//   gEmissive (R11F_G11F_B10F) : 线性空间自发光；有光照贴图的面改存烘焙辐照度
+//   深度纹理                    : 由 invViewProjection 重建世界坐标
+
+vec2 octWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+const int GBUFFER_FLAG_POM = 1;
+const int GBUFFER_FLAG_LIGHTMAP = 2;
+
+float encodeMaterialFlags(int flags)
+{
+    return float(flags) / 3.0;
+}
+
+int decodeMaterialFlags(float a)
+{
+    return int(a * 3.0 + 0.5);
+}
+
+// 单位向量 -> [0,1]^2
+vec2 octEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.z >= 0.0 ? n.xy : octWrap(n.xy);
+    return e * 0.5 + 0.5;
+}
+
+// [0,1]^2 -> 单位向量
+vec3 octDecode(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
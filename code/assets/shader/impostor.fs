@@ -0,0 +1,167 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ModelPos;
+flat in vec3 ModelCamPos;
+flat in mat4 ModelMatrix;
+flat in mat3 NormalMatrix;
+
+uniform sampler2D albedoAtlas;
+uniform sampler2D normalAtlas;
+uniform sampler2D depthAtlas;
+uniform int gridSize;
+uniform vec3 boundsCenter;
+uniform float boundsRadius;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform vec3 camPos;
+uniform vec3 environmentLight;
+
+#include "light_clusters.glsl"
+
+const float PI = 3.14159265359;
+
+// 半球八面体映射（y 轴向上），与 impostor.h 中的 hemiOctDecode 保持一致
+vec3 hemiOctDecode(vec2 e)
+{
+    vec2 t = vec2(e.x + e.y, e.x - e.y) * 0.5;
+    return normalize(vec3(t.x, 1.0 - abs(t.x) - abs(t.y), t.y));
+}
+
+vec2 hemiOctEncode(vec3 v)
+{
+    v.xz /= abs(v.x) + abs(v.y) + abs(v.z);
+    return vec2(v.x + v.z, v.x - v.z);
+}
+
+// 采样一帧：视线与该帧投影平面求交得到帧内 UV，按权重累加
+void sampleFrame(vec2 frame, vec3 rayDir, float weight,
+                 inout vec4 albedo, inout vec3 normal, inout vec3 surface, inout float roughness)
+{
+    vec3 f = hemiOctDecode(frame / float(gridSize - 1) * 2.0 - 1.0);
+    vec3 up = abs(f.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 r = normalize(cross(up, f));
+    vec3 u = cross(f, r);
+
+    float denom = dot(rayDir, f);
+    if (weight <= 0.0 || abs(denom) < 1e-4) return;
+    vec3 P = ModelPos - rayDir * (dot(ModelPos, f) / denom);
+    vec2 uv = vec2(dot(P, r), dot(P, u)) / (2.0 * boundsRadius) + 0.5;
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) return;
+
+    vec2 atlasUV = (frame + uv) / float(gridSize);
+    vec4 a = texture(albedoAtlas, atlasUV);
+    float w = weight * a.a;
+    if (w <= 0.0) return;
+
+    vec2 depthRough = texture(depthAtlas, atlasUV).rg;
+    albedo += vec4(a.rgb * w, w);
+    normal += (texture(normalAtlas, atlasUV).rgb * 2.0 - 1.0) * w;
+    surface += (P + f * boundsRadius * (1.0 - 2.0 * depthRough.r)) * w;
+    roughness += depthRough.g * w;
+}
+
+float DistributionGGX(vec3 N, vec3 H, float roughness)
+{
+    float a = roughness*roughness;
+    float a2 = a*a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH*NdotH;
+
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom + 0.0001;
+
+    return a2 / denom;
+}
+
+float GeometrySchlickGGX(float NdotV, float roughness)
+{
+    float r = (roughness + 1.0);
+    float k = (r*r) / 8.0;
+
+    return NdotV / (NdotV * (1.0 - k) + k);
+}
+
+float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
+{
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+    return GeometrySchlickGGX(NdotV, roughness) * GeometrySchlickGGX(NdotL, roughness);
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0)
+{
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+void main()
+{
+    vec3 rayDir = normalize(ModelPos - ModelCamPos);
+
+    // 视线方向（从物体指向相机）落在哪个八面体网格单元，取三角形的三帧做重心插值
+    vec3 viewDir = -rayDir;
+    viewDir.y = max(viewDir.y, 0.0);
+    vec2 grid = (hemiOctEncode(normalize(viewDir + vec3(0.0, 1e-4, 0.0))) * 0.5 + 0.5) * float(gridSize - 1);
+    vec2 base = clamp(floor(grid), vec2(0.0), vec2(float(gridSize - 2)));
+    vec2 t = clamp(grid - base, 0.0, 1.0);
+
+    vec4 albedo = vec4(0.0);
+    vec3 normal = vec3(0.0);
+    vec3 surface = vec3(0.0);
+    float roughness = 0.0;
+    if (t.x + t.y < 1.0)
+    {
+        sampleFrame(base,                  rayDir, 1.0 - t.x - t.y, albedo, normal, surface, roughness);
+        sampleFrame(base + vec2(1.0, 0.0), rayDir, t.x,             albedo, normal, surface, roughness);
+        sampleFrame(base + vec2(0.0, 1.0), rayDir, t.y,             albedo, normal, surface, roughness);
+    }
+    else
+    {
+        sampleFrame(base + vec2(1.0, 1.0), rayDir, t.x + t.y - 1.0, albedo, normal, surface, roughness);
+        sampleFrame(base + vec2(0.0, 1.0), rayDir, 1.0 - t.x,       albedo, normal, surface, roughness);
+        sampleFrame(base + vec2(1.0, 0.0), rayDir, 1.0 - t.y,       albedo, normal, surface, roughness);
+    }
+    if (albedo.a < 0.5) discard;
+
+    float totalWeight = albedo.a;
+    vec3 baseColor = pow(albedo.rgb / totalWeight, vec3(2.2));
+    roughness /= totalWeight;
+
+    // 写回真实深度，让替身与近处的几何正确遮挡
+    vec3 WorldPos = vec3(ModelMatrix * vec4(surface / totalWeight + boundsCenter, 1.0));
+    vec4 clipPos = projection * view * vec4(WorldPos, 1.0);
+    gl_FragDepth = clipPos.z / clipPos.w * 0.5 + 0.5;
+    int cluster = clusterIndex(gl_FragCoord.xy, gl_FragDepth);
+
+    vec3 N = normalize(NormalMatrix * normal);
+    vec3 V = normalize(camPos - WorldPos);
+    vec3 F0 = vec3(0.04);
+    vec3 Lo = vec3(0.0);
+
+    // 远景替身只做直接光照，不采样阴影
+    uvec2 range = clusterLightRange(cluster);
+    for(uint i = 0u; i < range.y; ++i)
+    {
+        PointLightData light = fetchClusterLight(range.x + i);
+        float distance = length(light.position - WorldPos);
+        if(distance > light.range) continue;
+
+        vec3 L = normalize(light.position - WorldPos);
+        vec3 H = normalize(V + L);
+        vec3 radiance = light.color * pointLightAttenuation(distance, light.range) * spotLightFactor(L, light.direction, light.cutOff);
+
+        float NDF = DistributionGGX(N, H, roughness);
+        float G   = GeometrySmith(N, V, L, roughness);
+        vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
+        vec3 specular = NDF * G * F / (4.0 * max(dot(N, V), 0.001) * max(dot(N, L), 0.001));
+        vec3 kD = vec3(1.0) - F;
+
+        float NdotL = max(dot(N, L), 0.0);
+        Lo += (kD * baseColor / PI + specular) * radiance * NdotL;
+    }
+
+    vec3 color = environmentLight * baseColor + Lo;
+
+    FragColor = vec4(color, 1.0);
+}
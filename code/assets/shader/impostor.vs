@@ -0,0 +1,36 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;         // 公告板角点 [-1, 1]
+layout (location = 4) in mat4 instanceMatrix;  // 物体模型矩阵（占用 location 4, 5, 6, 7）
+
+out vec3 ModelPos;           // 公告板上的点（模型空间，相对包围球心）
+flat out vec3 ModelCamPos;   // 相机位置（模型空间，相对包围球心）
+flat out mat4 ModelMatrix;
+flat out mat3 NormalMatrix;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform vec3 camPos;
+uniform vec3 boundsCenter;
+uniform float boundsRadius;
+
+void main()
+{
+    vec3 center = vec3(instanceMatrix * vec4(boundsCenter, 1.0));
+    float scale = max(length(instanceMatrix[0].xyz), max(length(instanceMatrix[1].xyz), length(instanceMatrix[2].xyz)));
+    float radius = boundsRadius * scale;
+
+    // 面向相机的公告板，向相机推进一个半径，保证光栅化深度在物体之前，真实深度由片段着色器写回
+    vec3 forward = normalize(camPos - center);
+    vec3 up = abs(forward.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(up, forward));
+    up = cross(forward, right);
+    vec3 worldPos = center + forward * radius + (right * aCorner.x + up * aCorner.y) * radius;
+
+    mat4 invModel = inverse(instanceMatrix);
+    ModelPos = vec3(invModel * vec4(worldPos, 1.0)) - boundsCenter;
+    ModelCamPos = vec3(invModel * vec4(camPos, 1.0)) - boundsCenter;
+    ModelMatrix = instanceMatrix;
+    NormalMatrix = transpose(inverse(mat3(instanceMatrix)));
+
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
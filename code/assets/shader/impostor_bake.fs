@@ -0,0 +1,53 @@
+#version 330 core
+layout (location = 0) out vec4 gAlbedo; // rgb: 基础色(gamma 空间存储), a: 覆盖率
+layout (location = 1) out vec4 gNormal; // rgb: 模型空间法线 * 0.5 + 0.5
+layout (location = 2) out vec4 gDepth;  // r: 沿烘焙方向的正交深度, g: 粗糙度
+
+in vec2 TexCoords;
+in mat3 TBN;
+
+uniform sampler2D albedoMap;
+uniform sampler2D normalMap;
+uniform sampler2D metallic_roughnessMap;
+
+uniform bool useAlbedoMap;
+uniform bool useNormalMap;
+uniform bool useMetallicRoughnessMap;
+
+uniform vec4 materialBaseColor;
+uniform float materialRoughness;
+uniform bool isGlass;
+
+void main()
+{
+    // 玻璃不进入替身贴图
+    if (isGlass) discard;
+
+    vec4 albedo = materialBaseColor;
+    if (useAlbedoMap)
+    {
+        vec4 texColor = texture(albedoMap, TexCoords);
+        texColor.rgb = pow(texColor.rgb, vec3(2.2));
+        albedo *= texColor;
+    }
+    if (albedo.a < 0.5) discard;
+
+    vec3 N = normalize(TBN[2]);
+    if (useNormalMap)
+    {
+        vec3 tangentNormal = texture(normalMap, TexCoords).xyz * 2.0 - 1.0;
+        N = normalize(TBN * tangentNormal);
+    }
+    if (!gl_FrontFacing) N = -N;
+
+    float roughness = materialRoughness;
+    if (useMetallicRoughnessMap)
+    {
+        roughness *= texture(metallic_roughnessMap, TexCoords).g;
+    }
+
+    // 所有输出 alpha 固定为 1，避免混合材质在 MRT 上把其它附件也混合掉
+    gAlbedo = vec4(pow(albedo.rgb, vec3(1.0 / 2.2)), 1.0);
+    gNormal = vec4(N * 0.5 + 0.5, 1.0);
+    gDepth = vec4(gl_FragCoord.z, clamp(roughness, 0.01, 0.99), 0.0, 1.0);
+}
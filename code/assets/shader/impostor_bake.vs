@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec3 aTangent;
+
+out vec2 TexCoords;
+out mat3 TBN;
+
+// 烘焙在模型空间进行，不需要 model 矩阵
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    TexCoords = aTexCoords;
+
+    vec3 N = normalize(aNormal);
+    vec3 T = normalize(aTangent - dot(aTangent, N) * N);
+    vec3 B = cross(N, T);
+    TBN = mat3(T, B, N);
+
+    gl_Position = projection * view * vec4(aPos, 1.0);
+}
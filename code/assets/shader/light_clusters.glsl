@@ -0,0 +1,81 @@
+// 分簇光源数据，由 clustered_lights.h 每帧生成
+//   pointLightData   (RGBA32F, 每个光源 3 个纹素): [position.xyz, range] [color.rgb, 阴影贴图下标，-1 为无阴影]
+//                    [direction.xyz, cutOff]，cutOff 为聚光锥半角余弦，0 表示全向点光源
+//   lightClusterData (R32UI): 前 clusterCount.x*y*z 个纹素是簇头 (偏移 << 8 | 数量)，之后是光源索引表
+uniform samplerBuffer pointLightData;
+uniform usamplerBuffer lightClusterData;
+uniform ivec3 clusterCount;
+uniform vec2 clusterTileSize; // 每个屏幕瓦片的像素尺寸
+uniform float clusterNear;
+uniform float clusterFar;
+
+struct PointLightData
+{
+    vec3 position;
+    float range;
+    vec3 color;
+    int shadowIndex;
+    vec3 direction; // 聚光方向
+    float cutOff;   // 聚光锥半角余弦，0 表示全向
+};
+
+// [0,1] 深度缓冲值 -> 视空间深度
+float linearizeDepth(float depth)
+{
+    float z = depth * 2.0 - 1.0;
+    return 2.0 * clusterNear * clusterFar / (clusterFar + clusterNear - z * (clusterFar - clusterNear));
+}
+
+// 屏幕坐标 + 深度缓冲值 -> 簇下标，深度切片按指数划分
+int clusterIndex(vec2 fragCoord, float depth)
+{
+    float viewDepth = linearizeDepth(depth);
+    int slice = int(floor(log(viewDepth / clusterNear) / log(clusterFar / clusterNear) * float(clusterCount.z)));
+    slice = clamp(slice, 0, clusterCount.z - 1);
+    ivec2 tile = clamp(ivec2(fragCoord / clusterTileSize), ivec2(0), clusterCount.xy - 1);
+    return tile.x + clusterCount.x * (tile.y + clusterCount.y * slice);
+}
+
+// 返回簇内光源在索引表中的 (起始位置, 数量)
+uvec2 clusterLightRange(int cluster)
+{
+    uint header = texelFetch(lightClusterData, cluster).r;
+    return uvec2(header >> 8u, header & 0xFFu);
+}
+
+PointLightData fetchPointLight(int lightIndex)
+{
+    vec4 t0 = texelFetch(pointLightData, lightIndex * 3);
+    vec4 t1 = texelFetch(pointLightData, lightIndex * 3 + 1);
+    vec4 t2 = texelFetch(pointLightData, lightIndex * 3 + 2);
+    PointLightData light;
+    light.position = t0.xyz;
+    light.range = t0.w;
+    light.color = t1.rgb;
+    light.shadowIndex = int(t1.w);
+    light.direction = t2.xyz;
+    light.cutOff = t2.w;
+    return light;
+}
+
+PointLightData fetchClusterLight(uint listIndex)
+{
+    return fetchPointLight(int(texelFetch(lightClusterData, int(listIndex)).r));
+}
+
+// 平方反比衰减乘窗函数，在 range 处平滑降到 0，簇的光源范围因此是严格的
+float pointLightAttenuation(float distance, float range)
+{
+    float ratio = distance / range;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window / (distance * distance);
+}
+
+// 聚光锥：锥边缘内侧 SPOT_EDGE 比例的余弦区间内平滑衰减，全向光源恒为 1
+const float SPOT_EDGE = 0.15;
+float spotLightFactor(vec3 L, vec3 direction, float cutOff)
+{
+    if (cutOff <= 0.0) return 1.0;
+    float cosTheta = dot(-L, direction);
+    return smoothstep(cutOff, cutOff + (1.0 - cutOff) * SPOT_EDGE, cosTheta);
+}
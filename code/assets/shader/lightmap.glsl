@@ -0,0 +1,14 @@
+// 静态图块的烘焙光照贴图（lightmap.h）：点光源直接光 + 多次反弹的间接光 + 天空，RGB9_E5
+// 与 irradianceMap 同一约定（漫反射 = 结果 * albedo）；坐标由 pbr.vs 按实例号和面朝向算出
+uniform bool useLightmap;
+uniform sampler2D lightmap;
+
+in vec3 LightmapCoord; // xy: 图集 uv, z > 0.5: 这个面有光照贴图
+
+bool sampleLightmap(out vec3 irradiance)
+{
+    irradiance = vec3(0.0);
+    if (!useLightmap || LightmapCoord.z < 0.5) return false;
+    irradiance = texture(lightmap, LightmapCoord.xy).rgb;
+    return true;
+}
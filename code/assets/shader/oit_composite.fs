@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D accumTexture;  // rgb: sum(C * a * w), a: prod(1 - a)
+uniform sampler2D weightTexture; // r: sum(a * w)
+
+// 加权混合 OIT 合成：加权平均颜色按总覆盖率叠加到不透明场景上
+void main()
+{
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    vec4 accum = texelFetch(accumTexture, coord, 0);
+    float revealage = accum.a;
+    if (revealage >= 0.9999) discard; // 该像素没有透明物体
+
+    float weight = texelFetch(weightTexture, coord, 0).r;
+    vec3 averageColor = accum.rgb / max(weight, 1e-5);
+
+    FragColor = vec4(averageColor, 1.0 - revealage);
+}
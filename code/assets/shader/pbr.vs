@@ -8,12 +8,16 @@ layout (location = 4) in mat4 instanceMatrix;
 // ʵݣռ location 8, 9, 10, 11
 layout (location = 8) in mat3 NormalMatrix; 
 
+//  depth_prepass.vs λһµĲü꣬ͨ GL_EQUAL Ȳ
+invariant gl_Position;
+
 out vec2 TexCoords;
 out vec3 WorldPos;
 out vec3 Normal;
 out mat3 TBN;
 out vec3 TangentViewPos;
 out vec3 TangentFragPos;
+out vec3 LightmapCoord; //  lightmap.glsl
 
 uniform bool useInstance;
 
@@ -25,8 +29,22 @@ uniform mat4 view;
 uniform vec3 camPos;
 uniform float texScale; // 
 
+// ͼlightmap.hʵ k ϱǵ lightmapBase + 2k ͼ±һ-1 ʾʵûйͼ
+const float LIGHTMAP_CHART_SIZE = 32.0;
+uniform int lightmapBase;
+uniform int lightmapColumns;
+uniform vec2 lightmapSize;
+
 void main()
 {
+    LightmapCoord = vec3(0.0);
+    if (useInstance && lightmapBase >= 0 && abs(aNormal.y) > 0.5)
+    {
+        int chart = lightmapBase + gl_InstanceID * 2 + (aNormal.y > 0.0 ? 0 : 1);
+        vec2 cell = vec2(chart % lightmapColumns, chart / lightmapColumns);
+        LightmapCoord = vec3((cell * LIGHTMAP_CHART_SIZE + 0.5 + aTexCoords * (LIGHTMAP_CHART_SIZE - 1.0)) / lightmapSize, 1.0);
+    }
+
     if(useInstance)
     {
         WorldPos = vec3(instanceMatrix * vec4(aPos, 1.0));
@@ -0,0 +1,583 @@
+// PBR 光照：Cook-Torrance 点光源/聚光灯（分簇）、软阴影、平行光级联阴影与 IBL 环境光，pbr.fs 与 deferred_lighting.fs 共用
+// 包含者需先声明 camPos
+
+#include "light_clusters.glsl"
+
+const float PI = 3.14159265359;
+
+// IBL
+uniform samplerCube irradianceMap;   
+uniform samplerCube prefilterMap;     
+uniform sampler2D brdfLUT;    
+//
+uniform vec3 environmentLight;
+// 烘焙的辐照度探针网格（light_probes.h）：L2 球谐，网格内的漫反射环境光取代 irradianceMap/environmentLight
+// 二维纹理 x 方向分 9 段，第 i 段为所有探针的第 i 个系数；y 方向分 nz 段，每段一层探针
+uniform bool useLightProbes;
+uniform sampler2D lightProbes;
+uniform vec3 lightProbeMin;
+uniform vec3 lightProbeMax;
+uniform ivec3 lightProbeCount;
+const float LIGHT_PROBE_NORMAL_BIAS = 0.3; // 与 light_probes.h 一致
+
+// 局部反射探针（reflection_probes.h）：按槽位存放，position.w 为 0 的槽位还没有有效结果
+const int MAX_REFLECTION_PROBES = 4;
+uniform bool useReflectionProbes;
+uniform samplerCube reflectionProbes[MAX_REFLECTION_PROBES];
+uniform vec4 reflectionProbePosition[MAX_REFLECTION_PROBES];
+uniform vec3 reflectionProbeBoxMin[MAX_REFLECTION_PROBES];       // 视差校正的投影盒
+uniform vec3 reflectionProbeBoxMax[MAX_REFLECTION_PROBES];
+uniform vec3 reflectionProbeInfluenceMin[MAX_REFLECTION_PROBES]; // 影响范围，已外扩渐变宽度
+uniform vec3 reflectionProbeInfluenceMax[MAX_REFLECTION_PROBES];
+uniform float reflectionProbeFade;
+// 投射阴影的点光源（其余光源只有直接光照），6 个立方体面都在同一张阴影图集里
+// 聚光灯只有一张透视阴影图，占用该光源的第 0 个区域
+#define MAX_SHADOWED_POINT_LIGHTS 32
+uniform sampler2D shadowAtlas;
+uniform vec4 shadowAtlasRects[MAX_SHADOWED_POINT_LIGHTS * 6]; // 图集 uv：xy 左下角，z 边长，z 为 0 表示本帧无阴影
+uniform float shadowAtlasTexel; // 1 / 图集边长
+uniform sampler2DShadow shadowAtlasCompare; // 同一张图集，比较模式 + 线性过滤（硬件 2x2 PCF）
+uniform sampler2D shadowMoments; // 矩图集 (d, d^2)：布局同深度图集、分辨率减半，已模糊并带 mipmap
+uniform float shadowMomentTexel; // 1 / 矩图集边长
+uniform int shadowFilterMode; // 0: 20 次逐点采样, 1: 硬件 PCF, 2: 矩阴影
+uniform int pcfTaps; // 硬件 PCF 的最多采样数 4 或 8，画质调节器或 TAA 开启时会降低
+uniform float shadowNoiseOffset; // PCF 旋转角的逐帧偏移 [0, 1)，TAA 开启时每帧变化，由累积抹平噪声
+uniform int pointShadowLayout; // 点光源阴影布局 0: 立方体 6 面, 1: 四面体 4 面
+
+// 屏幕空间阴影遮罩（shadow_mask.fs 生成），只在前向渲染的不透明通道启用
+uniform bool useShadowMask;
+uniform sampler2D shadowMask;      // 通道 c: 簇内第一个 shadowIndex & 3 == c 的阴影光源的遮挡比例
+uniform sampler2D shadowMaskDepth; // 生成遮罩时用的全分辨率深度
+uniform int shadowMaskScale;       // 1: 全分辨率, 2: 半分辨率
+const float SHADOW_MASK_DEPTH_TOLERANCE = 0.02; // 线性深度相对差超过该值的遮罩纹素不可用
+
+// 平行光（太阳）与级联阴影，级联按距离从近到远排列在同一个纹理数组里
+struct DirLight {
+    vec3 direction; // 从光源指向场景的方向
+    vec3 color;
+    bool enabled;
+};
+uniform DirLight dirLight;
+#define MAX_CASCADES 4
+uniform sampler2DArrayShadow dirShadowMap; // 比较模式 + 线性过滤
+uniform mat4 dirLightMatrices[MAX_CASCADES];
+uniform float cascadeTexelSizes[MAX_CASCADES]; // 每级一个纹素的世界尺寸
+uniform int cascadeCount;
+
+// 采样偏移数组
+vec3 sampleOffsetDirections[20] = vec3[] (
+    vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
+    vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1),
+    vec3( 1,  0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1,  0, -1),
+    vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1),
+    vec3( 1,  1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1,  1,  0)
+);
+
+// 硬件 PCF 用的泊松盘，前 4 个样本各占一个象限，用于提前结束
+const vec2 poissonDisk[8] = vec2[] (
+    vec2(-0.326, -0.406), vec2(-0.696,  0.457), vec2( 0.519,  0.767), vec2( 0.473, -0.480),
+    vec2(-0.840, -0.074), vec2(-0.203,  0.621), vec2( 0.962, -0.195), vec2( 0.185, -0.893)
+);
+
+// GGX/Trowbridge-Reitz 法线分布函数
+float DistributionGGX(vec3 N, vec3 H, float roughness)
+{
+    float a = roughness*roughness;
+    float a2 = a*a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH*NdotH;
+
+    float nom   = a2;
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom + 0.0001;
+
+    return nom / denom;
+}
+
+// 几何遮挡函数（Schlick-GGX）
+float GeometrySchlickGGX(float NdotV, float roughness)
+{
+    float r = (roughness + 1.0);
+    float k = (r*r) / 8.0;
+
+    float nom   = NdotV;
+    float denom = NdotV * (1.0 - k) + k;
+
+    return nom / denom;
+}
+
+// 几何阴影函数（Smith）
+float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
+{
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+    float ggx2 = GeometrySchlickGGX(NdotV, roughness);
+    float ggx1 = GeometrySchlickGGX(NdotL, roughness);
+
+    return ggx1 * ggx2;
+}
+
+
+// 菲涅尔方程（基础版）
+vec3 fresnelSchlick(float cosTheta, vec3 F0)
+{
+    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+// 菲涅尔方程（带粗糙度，用于IBL）
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
+{
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+// 按 GL 立方体贴图的选面规则求面下标和面内坐标 st（阴影矩阵的 up 向量与之对应）
+int cubeFaceCoord(vec3 d, out vec2 st)
+{
+    vec3 a = abs(d);
+    int face;
+    float ma;
+    vec2 sc;
+    if (a.x >= a.y && a.x >= a.z)
+    {
+        face = d.x > 0.0 ? 0 : 1;
+        ma = a.x;
+        sc = vec2(d.x > 0.0 ? -d.z : d.z, -d.y);
+    }
+    else if (a.y >= a.z)
+    {
+        face = d.y > 0.0 ? 2 : 3;
+        ma = a.y;
+        sc = vec2(d.x, d.y > 0.0 ? d.z : -d.z);
+    }
+    else
+    {
+        face = d.z > 0.0 ? 4 : 5;
+        ma = a.z;
+        sc = vec2(d.z > 0.0 ? d.x : -d.x, -d.y);
+    }
+    st = sc / ma * 0.5 + 0.5;
+    return face;
+}
+
+// 四面体布局：面法线和 up 向量与 shadow_atlas.h 的 TETRA_FACE_NORMALS / TETRA_FACE_UPS 一致
+const vec3 tetraFaceNormals[4] = vec3[] (
+    vec3( 0.577350,  0.577350,  0.577350), vec3( 0.577350, -0.577350, -0.577350),
+    vec3(-0.577350,  0.577350, -0.577350), vec3(-0.577350, -0.577350,  0.577350)
+);
+const vec3 tetraFaceUps[4] = vec3[] (
+    vec3(-0.816497,  0.408248,  0.408248), vec3( 0.408248, -0.408248,  0.816497),
+    vec3( 0.816497,  0.408248, -0.408248), vec3(-0.408248, -0.408248, -0.816497)
+);
+const float TETRA_TAN_X = 2.5;
+const float TETRA_TAN_BOTTOM = -1.45;
+const float TETRA_TAN_TOP = 2.9;
+
+// 取点积最大的面法线，按该面的非对称视锥求面内坐标（与 glm::lookAt + glm::frustum 一致）
+int tetraFaceCoord(vec3 d, out vec2 st)
+{
+    int face = 0;
+    float best = dot(d, tetraFaceNormals[0]);
+    for (int i = 1; i < 4; ++i)
+    {
+        float v = dot(d, tetraFaceNormals[i]);
+        if (v > best) { best = v; face = i; }
+    }
+    vec3 f = tetraFaceNormals[face];
+    vec3 u = tetraFaceUps[face];
+    vec3 s = cross(f, u);
+    vec2 t = vec2(dot(d, s), dot(d, u)) / best;
+    st = (t - vec2(-TETRA_TAN_X, TETRA_TAN_BOTTOM)) / vec2(2.0 * TETRA_TAN_X, TETRA_TAN_TOP - TETRA_TAN_BOTTOM);
+    return face;
+}
+
+// 聚光灯阴影图的面内坐标，基向量与 C++ 中 glm::lookAt 的 up 选择一致（spot: 方向 + 半角余弦）
+vec2 spotFaceCoord(vec3 d, vec4 spot)
+{
+    vec3 f = spot.xyz;
+    vec3 s = normalize(cross(f, abs(f.y) > 0.99 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0)));
+    vec3 u = cross(s, f);
+    float tanHalf = sqrt(1.0 - spot.w * spot.w) / spot.w;
+    float z = max(dot(d, f), 1e-4);
+    return vec2(dot(d, s), dot(d, u)) / (z * tanHalf) * 0.5 + 0.5;
+}
+
+// 点光源按立方体或四面体选面，聚光灯只有第 0 面
+int shadowFaceCoord(vec3 d, vec4 spot, out vec2 st)
+{
+    if (spot.w > 0.0)
+    {
+        st = spotFaceCoord(d, spot);
+        return 0;
+    }
+    if (pointShadowLayout == 1)
+        return tetraFaceCoord(d, st);
+    return cubeFaceCoord(d, st);
+}
+
+// 方向对应的图集坐标；夹在面内半个纹素，双线性过滤也不会采到图集里相邻的面
+vec2 shadowAtlasUV(int shadowIndex, vec4 spot, vec3 direction)
+{
+    vec2 st;
+    int face = shadowFaceCoord(direction, spot, st);
+    vec4 rect = shadowAtlasRects[shadowIndex * 6 + face];
+    vec2 halfTexel = vec2(0.5 * shadowAtlasTexel);
+    return clamp(rect.xy + st * rect.z, rect.xy + halfTexel, rect.xy + rect.z - halfTexel);
+}
+
+// 返回归一化的最近距离
+float sampleShadowAtlas(int shadowIndex, vec4 spot, vec3 direction)
+{
+    return texture(shadowAtlas, shadowAtlasUV(shadowIndex, spot, direction)).r;
+}
+
+// 硬件比较：返回受光比例（相邻 4 个纹素分别与 refDepth 比较后双线性插值）
+float sampleShadowAtlasCompare(int shadowIndex, vec4 spot, vec3 direction, float refDepth)
+{
+    return texture(shadowAtlasCompare, vec3(shadowAtlasUV(shadowIndex, spot, direction), refDepth));
+}
+
+// 旋转泊松盘 PCF：盘面垂直于光线方向，每像素随机旋转角把条带变成噪点（TAA 开启时旋转角逐帧变化）
+// 前 4 个样本全亮或全暗时直接返回，只有半影区取满 8 个样本（pcfTaps 为 4 时总是只取 4 个）
+float hardwarePointShadow(vec3 fragToLight, float currentDepth, int shadowIndex, vec4 spot, float far_plane, float bias, float diskRadius)
+{
+    vec3 dir = fragToLight / currentDepth;
+    vec3 T = normalize(cross(dir, abs(dir.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 B = cross(dir, T);
+    float angle = 6.2831853 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))) + shadowNoiseOffset);
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    float refDepth = (currentDepth - bias) / far_plane;
+
+    float lit = 0.0;
+    for (int i = 0; i < 8; ++i)
+    {
+        vec2 p = rotation * poissonDisk[i] * diskRadius * 1.5;
+        lit += sampleShadowAtlasCompare(shadowIndex, spot, fragToLight + T * p.x + B * p.y, refDepth);
+        if (i == 3 && (lit == 0.0 || lit == 4.0 || pcfTaps <= 4))
+            return 1.0 - lit / 4.0;
+    }
+    return 1.0 - lit / 8.0;
+}
+
+// 矩阴影：一次三线性采样，mip 级别让一个矩纹素与像素的世界尺寸相当（footprint 为像素的世界尺寸）
+// 切比雪夫上界给出受光概率，再截掉低于 0.3 的部分以减轻漏光
+float momentPointShadow(vec3 fragToLight, float currentDepth, int shadowIndex, vec4 spot, float far_plane, float bias, float footprint)
+{
+    vec2 st;
+    int face = shadowFaceCoord(fragToLight, spot, st);
+    vec4 rect = shadowAtlasRects[shadowIndex * 6 + face];
+    float tanHalf = spot.w > 0.0 ? sqrt(1.0 - spot.w * spot.w) / spot.w : (pointShadowLayout == 1 ? TETRA_TAN_X : 1.0); // 立方体面为 90°
+    float texelWorld = 2.0 * currentDepth * tanHalf * shadowMomentTexel / rect.z; // 一个矩纹素在该距离处的大小
+    float lod = clamp(log2(max(footprint / texelWorld, 1.0)), 0.0, 3.0);
+    vec2 halfTexel = vec2(0.5 * shadowMomentTexel * exp2(ceil(lod)));
+    vec2 uv = clamp(rect.xy + st * rect.z, rect.xy + halfTexel, rect.xy + rect.z - halfTexel);
+    vec2 moments = textureLod(shadowMoments, uv, lod).rg;
+
+    float t = (currentDepth - bias) / far_plane;
+    if (t <= moments.x) return 0.0;
+    float variance = max(moments.y - moments.x * moments.x, 0.00002);
+    float d = t - moments.x;
+    float pMax = variance / (variance + d * d);
+    pMax = clamp((pMax - 0.3) / 0.7, 0.0, 1.0);
+    return 1.0 - pMax;
+}
+
+// 软阴影计算（spot: 聚光方向 + 半角余弦，w 为 0 表示点光源；pom: 视差表面加大偏移, glass: 玻璃特殊处理,
+// footprint: 像素的世界尺寸，仅矩阴影使用）
+float calculatePointShadow(vec3 fragPos, int shadowIndex, vec4 spot, vec3 lightPos, float far_plane, vec3 N, bool pom, bool glass, float footprint) 
+{
+    vec3 fragToLight = fragPos - lightPos;
+    float currentDepth = length(fragToLight);
+
+    float shadow = 0.0;
+    float NdotL = max(dot(N, normalize(lightPos - fragPos)), 0.0);
+    
+    float bias = pom ? 0.08 : mix(0.015, 0.005, NdotL);
+    
+    if (glass) bias = 0.5; // 玻璃特殊处理
+
+    vec2 st;
+    if (shadowAtlasRects[shadowIndex * 6 + shadowFaceCoord(fragToLight, spot, st)].z == 0.0) return 0.0; // 没分到图集空间或该面还没画过
+    
+    int samples = 20;
+    float diskRadius = (1.0 + (length(camPos - fragPos) / far_plane)) / 25.0;
+
+    if (shadowFilterMode == 1)
+        return currentDepth > far_plane ? 0.0 : hardwarePointShadow(fragToLight, currentDepth, shadowIndex, spot, far_plane, bias, diskRadius);
+    if (shadowFilterMode == 2)
+        return currentDepth > far_plane ? 0.0 : momentPointShadow(fragToLight, currentDepth, shadowIndex, spot, far_plane, bias, footprint);
+    
+    for(int i = 0; i < samples; ++i) 
+    {
+        float closestDepth = sampleShadowAtlas(shadowIndex, spot, fragToLight + sampleOffsetDirections[i] * diskRadius);
+        closestDepth *= far_plane;
+        if(currentDepth - bias > closestDepth) 
+            shadow += 1.0;
+    }
+    shadow /= float(samples);
+    if(currentDepth > far_plane) 
+        shadow = 0.0;
+
+    return shadow;
+}
+
+// 读阴影遮罩：取周围 2x2 个遮罩纹素，按双线性权重混合深度与本像素相符的那些（半分辨率时即深度感知上采样）
+// 遮罩通道按簇分配，相邻纹素落在别的簇时同一通道可能是另一盏灯，也要拒绝
+// 全部对不上（物体轮廓处、簇边界处）返回 false，由调用者自己算阴影
+bool readShadowMask(int cluster, out vec4 mask)
+{
+    float depth = linearizeDepth(gl_FragCoord.z);
+    vec2 maskPos = gl_FragCoord.xy / float(shadowMaskScale) - 0.5;
+    ivec2 base = ivec2(floor(maskPos));
+    vec2 f = fract(maskPos);
+    ivec2 maxTexel = textureSize(shadowMask, 0) - 1;
+    mask = vec4(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), maxTexel);
+        ivec2 maskPixel = texel * shadowMaskScale;
+        float rawDepth = texelFetch(shadowMaskDepth, maskPixel, 0).r;
+        float maskDepth = linearizeDepth(rawDepth);
+        if (abs(maskDepth - depth) > depth * SHADOW_MASK_DEPTH_TOLERANCE) continue;
+        if (clusterIndex(vec2(maskPixel) + 0.5, rawDepth) != cluster) continue;
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float weight = bilinear.x * bilinear.y + 1e-4; // 保底权重：其余纹素都被拒绝时，双线性权重为 0 的纹素仍可用
+        mask += texelFetch(shadowMask, texel, 0) * weight;
+        weightSum += weight;
+    }
+    if (weightSum == 0.0) return false;
+    mask /= weightSum;
+    return true;
+}
+
+// 所在簇内点光源的直接光照（含阴影），cluster 由 clusterIndex() 求得
+vec3 pointLighting(int cluster, vec3 P, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, vec3 F0, bool pom, bool glass)
+{
+    vec3 Lo = vec3(0.0);
+    // 导数要在分支外求（矩阴影选 mip 用）
+    float footprint = max(length(dFdx(P)), length(dFdy(P)));
+    // 阴影遮罩不知道视差与玻璃的偏移，这两种表面自己算
+    vec4 mask;
+    bool maskValid = useShadowMask && !pom && !glass && readShadowMask(cluster, mask);
+    bvec4 maskUsed = bvec4(false);
+    uvec2 range = clusterLightRange(cluster);
+    for(uint i = 0u; i < range.y; ++i) 
+    {   
+        PointLightData light = fetchClusterLight(range.x + i);
+        // 遮罩通道分配须与 shadow_mask.fs 一致，所以在范围/聚光锥剔除之前占用
+        int maskChannel = -1;
+        if (maskValid && light.shadowIndex >= 0 && !maskUsed[light.shadowIndex & 3])
+        {
+            maskChannel = light.shadowIndex & 3;
+            maskUsed[maskChannel] = true;
+        }
+        vec3 L = normalize(light.position - P);
+        float distance = length(light.position - P);
+        vec3 H = normalize(V + L);
+
+        if(distance > light.range){continue;};
+        float spotFactor = spotLightFactor(L, light.direction, light.cutOff);
+        if(spotFactor == 0.0){continue;};
+
+        float attenuation = pointLightAttenuation(distance, light.range);
+        vec3 radiance = light.color * attenuation * spotFactor;
+
+        // BRDF计算
+        float NDF = DistributionGGX(N, H, roughness);   
+        float G   = GeometrySmith(N, V, L, roughness);      
+        vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
+           
+        vec3 numerator    = NDF * G * F; 
+        float denominator = 4.0 * max(dot(N, V), 0.001) * max(dot(N, L), 0.001);
+        vec3 specular = numerator / denominator;
+        
+        // 能量守恒
+        vec3 kS = F;
+        vec3 kD = vec3(1.0) - kS;
+        kD *= 1.0 - metallic;	 
+
+        // 阴影计算
+        float shadowFactor = 1.0;
+        if (maskChannel >= 0)
+            shadowFactor -= mask[maskChannel];
+        else if (light.shadowIndex >= 0)
+            shadowFactor -= calculatePointShadow(P, light.shadowIndex, vec4(light.direction, light.cutOff), light.position, light.range, N, pom, glass, footprint);
+
+        float NdotL = max(dot(N, L), 0.0);        
+        Lo += (kD * albedo / PI + specular) * radiance * NdotL * shadowFactor;
+    }
+    return Lo;
+}
+
+// 平行光阴影：取第一个完整覆盖该点的级联（越近的级联纹素越小），返回遮挡比例
+float dirLightShadow(vec3 P, vec3 N, vec3 L)
+{
+    float NdotL = max(dot(N, L), 0.0);
+    float texel = 1.0 / float(textureSize(dirShadowMap, 0).x);
+    for (int i = 0; i < MAX_CASCADES; ++i)
+    {
+        if (i >= cascadeCount) break;
+        // 沿法线偏移 1~3 个该级纹素，掠射角时偏移更大
+        vec3 offsetP = P + N * cascadeTexelSizes[i] * (1.0 + 2.0 * (1.0 - NdotL));
+        vec3 coord = (dirLightMatrices[i] * vec4(offsetP, 1.0)).xyz * 0.5 + 0.5;
+        if (any(lessThan(coord.xy, vec2(2.0 * texel))) || any(greaterThan(coord.xy, vec2(1.0 - 2.0 * texel))) || coord.z > 1.0)
+            continue;
+
+        // 4 次硬件比较采样，相当于 3x3 纹素的 PCF
+        float lit = 0.0;
+        lit += texture(dirShadowMap, vec4(coord.xy + vec2(-0.5, -0.5) * texel, float(i), coord.z));
+        lit += texture(dirShadowMap, vec4(coord.xy + vec2( 0.5, -0.5) * texel, float(i), coord.z));
+        lit += texture(dirShadowMap, vec4(coord.xy + vec2(-0.5,  0.5) * texel, float(i), coord.z));
+        lit += texture(dirShadowMap, vec4(coord.xy + vec2( 0.5,  0.5) * texel, float(i), coord.z));
+        return 1.0 - lit * 0.25;
+    }
+    return 0.0; // 超出最远级联：不投影
+}
+
+// 平行光直接光照，乘以级联阴影
+vec3 dirLightCalculate(vec3 P, vec3 N, vec3 V, vec3 albedo, vec3 F0, float roughness, float metallic, float alpha, bool glass)
+{
+    vec3 L = normalize(-dirLight.direction);
+    vec3 H = normalize(V + L);
+    vec3 radiance = dirLight.color * (1.0 - dirLightShadow(P, N, L));
+
+    // Cook-Torrance BRDF
+    float NDF = DistributionGGX(N, H, roughness);   
+    float G   = GeometrySmith(N, V, L, roughness);      
+    vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
+           
+    vec3 numerator    = NDF * G * F; 
+    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    vec3 specular = numerator / denominator;
+        
+    vec3 kS = F;
+    vec3 kD = (vec3(1.0) - kS) * (1.0 - metallic);
+    float NdotL = max(dot(N, L), 0.0);        
+
+    if (glass) 
+    {
+        // 玻璃透射近似
+        float thicknessFactor = 1.0 - pow(max(dot(N, V), 0.0), 2.0);
+        vec3 transmitLight = radiance * albedo * alpha * thicknessFactor * (1.0 - roughness * 0.5);
+        return (specular * radiance * NdotL) + (transmitLight * kD);
+    } 
+    return (kD * albedo / PI + specular) * radiance * NdotL;
+}
+
+bool insideLightProbes(vec3 P)
+{
+    return useLightProbes && all(greaterThanEqual(P, lightProbeMin)) && all(lessThanEqual(P, lightProbeMax));
+}
+
+// 三线性插值探针的球谐系数并按法线求值：层内靠硬件双线性，相邻两层手动插值
+// 坐标限制在纹素中心之间，线性过滤不会读到相邻一段
+vec3 sampleLightProbes(vec3 P, vec3 N)
+{
+    vec3 grid = vec3(lightProbeCount - 1);
+    vec3 cell = clamp((P + N * LIGHT_PROBE_NORMAL_BIAS - lightProbeMin) / (lightProbeMax - lightProbeMin) * grid, vec3(0.0), grid);
+    vec2 size = vec2(float(lightProbeCount.x * 9), float(lightProbeCount.y * lightProbeCount.z));
+    float z0 = floor(cell.z);
+    float z1 = min(z0 + 1.0, grid.z);
+    float tz = cell.z - z0;
+    vec2 row = vec2(z0, z1) * float(lightProbeCount.y) + cell.y + 0.5;
+
+    float basis[9] = float[](
+        0.282095,
+        0.488603 * N.y, 0.488603 * N.z, 0.488603 * N.x,
+        1.092548 * N.x * N.y, 1.092548 * N.y * N.z, 0.315392 * (3.0 * N.z * N.z - 1.0),
+        1.092548 * N.x * N.z, 0.546274 * (N.x * N.x - N.y * N.y)
+    );
+    vec3 irradiance = vec3(0.0);
+    for (int i = 0; i < 9; ++i)
+    {
+        float column = cell.x + float(i * lightProbeCount.x) + 0.5;
+        vec3 c0 = texture(lightProbes, vec2(column, row.x) / size).rgb;
+        vec3 c1 = texture(lightProbes, vec2(column, row.y) / size).rgb;
+        irradiance += mix(c0, c1, tz) * basis[i];
+    }
+    return max(irradiance, vec3(0.0));
+}
+
+// GLSL 3.30 的采样器数组只能用常量下标
+vec3 sampleReflectionProbe(int slot, vec3 direction, float lod)
+{
+    if (slot == 0) return textureLod(reflectionProbes[0], direction, lod).rgb;
+    if (slot == 1) return textureLod(reflectionProbes[1], direction, lod).rgb;
+    if (slot == 2) return textureLod(reflectionProbes[2], direction, lod).rgb;
+    return textureLod(reflectionProbes[3], direction, lod).rgb;
+}
+
+// 盒投影视差校正：反射光线从 P 出发与投影盒的出射交点，换成从探针位置看过去的方向
+vec3 boxProjectedDirection(int slot, vec3 P, vec3 R)
+{
+    vec3 t1 = (reflectionProbeBoxMax[slot] - P) / R;
+    vec3 t2 = (reflectionProbeBoxMin[slot] - P) / R;
+    vec3 tFar = max(t1, t2);
+    float t = min(min(tFar.x, tFar.y), tFar.z);
+    return P + R * t - reflectionProbePosition[slot].xyz;
+}
+
+// 覆盖 P 的探针按到影响范围边缘的距离渐变加权混合；没有覆盖 P 的有效探针时返回 false
+bool sampleReflectionProbes(vec3 P, vec3 R, float lod, out vec3 color)
+{
+    color = vec3(0.0);
+    if (!useReflectionProbes) return false;
+    float totalWeight = 0.0;
+    for (int i = 0; i < MAX_REFLECTION_PROBES; ++i)
+    {
+        if (reflectionProbePosition[i].w < 0.5) continue;
+        vec3 inside = min(P - reflectionProbeInfluenceMin[i], reflectionProbeInfluenceMax[i] - P);
+        float weight = clamp(min(min(inside.x, inside.y), inside.z) / (2.0 * reflectionProbeFade), 0.0, 1.0);
+        if (weight <= 0.0) continue;
+        color += sampleReflectionProbe(i, boxProjectedDirection(i, P, R), lod) * weight;
+        totalWeight += weight;
+    }
+    if (totalWeight <= 0.0) return false;
+    color /= totalWeight;
+    return true;
+}
+
+// 给定漫反射辐照度（探针 / irradianceMap / 常量 / 光照贴图，约定 漫反射 = irradiance * albedo）的环境光
+// 不用 IBL 时只有漫反射；用 IBL 时再加分裂和近似的镜面反射
+vec3 ambientFromIrradiance(vec3 P, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, float ao, vec3 F0, bool ibl, vec3 irradiance)
+{
+    if(!ibl)
+    {
+        return irradiance * albedo * ao;
+    }
+
+    // IBL环境光计算
+    vec3 R = reflect(-V, N); 
+    vec3 F = fresnelSchlickRoughness(max(dot(N, V), 0.0), F0, roughness);
+    vec3 kS = F;
+    vec3 kD = 1.0 - kS;
+    kD *= 1.0 - metallic;	  
+
+    // 漫反射 IBL
+    vec3 diffuse = irradiance * albedo;
+
+    // 镜面反射 IBL：室内优先用视差校正后的局部反射探针
+    const float MAX_REFLECTION_LOD = 4.0;
+    vec3 prefilteredColor;
+    if (!sampleReflectionProbes(P, R, roughness * MAX_REFLECTION_LOD, prefilteredColor))
+        prefilteredColor = textureLod(prefilterMap, R, roughness * MAX_REFLECTION_LOD).rgb;
+    vec2 brdf = texture(brdfLUT, vec2(max(dot(N, V), 0.0), roughness)).rg;
+    vec3 specular = prefilteredColor * (F * brdf.x + brdf.y);
+
+    // 环境光叠加AO
+    return (kD * diffuse + specular) * ao;
+}
+
+// 环境光：IBL 或常量环境光，叠加 AO；探针网格内的漫反射改用烘焙的探针
+vec3 ambientLighting(vec3 P, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, float ao, vec3 F0, bool ibl)
+{
+    vec3 irradiance;
+    if (insideLightProbes(P))
+        irradiance = sampleLightProbes(P, N);
+    else if (ibl)
+        irradiance = clamp(texture(irradianceMap, N).rgb, vec3(0.0), vec3(0.5)); // 限制环境光强度
+    else
+        irradiance = environmentLight;
+    return ambientFromIrradiance(P, N, V, albedo, metallic, roughness, ao, F0, ibl, irradiance);
+}
\ No newline at end of file
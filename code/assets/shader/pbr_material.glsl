@@ -0,0 +1,182 @@
+// PBR 材质采样：视差贴图、各材质贴图与因子，pbr.fs 与 gbuffer.fs 共用
+// 包含者需先声明 pbr.vs 的输出（TexCoords, WorldPos, Normal, TBN, TangentViewPos, TangentFragPos）和 camPos
+
+uniform sampler2D albedoMap;
+uniform sampler2D normalMap;
+uniform sampler2D metallicMap;
+uniform sampler2D roughnessMap;
+uniform sampler2D aoMap;
+uniform sampler2D metallic_roughnessMap;   
+uniform sampler2D emissiveMap;
+uniform sampler2D transmissionMap;
+uniform sampler2D heightMap;
+//gltf
+uniform bool gltf;
+//useMaterial?
+uniform bool useAlbedoMap;
+uniform bool useNormalMap;
+uniform bool useMetallicRoughnessMap;
+uniform bool useMetallicMap;
+uniform bool useRoughnessMap;
+uniform bool useAOMap;
+uniform bool useEmissiveMap;
+uniform bool useheightMap;
+uniform bool useTransmissionMap;
+//Factor
+uniform vec4 materialBaseColor;
+uniform vec3 materialEmissive;
+uniform float materialMetallic;
+uniform float materialRoughness;
+uniform float materialTransmission;
+//POM
+uniform bool usePOM;
+uniform float heightScale; 
+uniform int pomMaxSteps;   // 掠射角时的步数，画质调节器会降低
+// glass
+uniform bool isGlass;
+uniform bool doubleSided;
+
+// 锥步进视差：heightMap 为 cone_map.h 生成的锥图（r: 深度, g: sqrt(锥宽高比)）
+// 每步沿视线前进到当前点下方表面纹素的锥面上，锥内没有更高的纹素，所以不会穿过表面，逐步逼近交点
+vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir, float currentHeightScale)
+{
+    // 预计算导数
+    vec2 dx = dFdx(texCoords);
+    vec2 dy = dFdy(texCoords);
+
+    if(!useheightMap) return texCoords;
+
+    // 视角越平(z越小)，步数越多
+    const float minSteps = 6.0;
+    float maxSteps = max(float(pomMaxSteps), minSteps);
+    int numSteps = int(mix(maxSteps, minSteps, abs(viewDir.z)));
+
+    // 每单位深度的 uv 偏移（与视线方向相反，即射入表面的方向）
+    vec3 rayDir = vec3(-viewDir.xy / max(viewDir.z, 0.00001) * currentHeightScale, 1.0);
+    float rayRatio = length(rayDir.xy);
+    vec3 ray = vec3(texCoords, 0.0);
+
+    for(int i = 0; i < numSteps; ++i)
+    {
+        vec2 cone = textureGrad(heightMap, ray.xy, dx, dy).rg;
+        float coneRatio = cone.g * cone.g;
+        float gap = cone.r - ray.z;
+        if(gap < 0.001) break;
+        // 视线与锥面的交点：深度方向前进 gap * coneRatio / (coneRatio + rayRatio)
+        ray += rayDir * (gap * coneRatio / (coneRatio + rayRatio));
+    }
+    return ray.xy;
+}
+
+vec3 getNormalFromMap(vec2 uv)
+{
+    if (!useNormalMap) return normalize(Normal);
+
+    vec3 tangentNormal = texture(normalMap, uv).xyz * 2.0 - 1.0;
+
+    return normalize(TBN * tangentNormal);
+}
+
+// 采样后的表面属性（线性空间）
+struct SurfaceData
+{
+    vec3 albedo;
+    float alpha;
+    float metallic;
+    float roughness;
+    float ao;
+    vec3 emissive;
+    vec3 N;
+};
+
+SurfaceData sampleSurface()
+{
+    // 距离淡出
+    float viewDistance = length(camPos - WorldPos);
+    float pomFadeStart = 10.0;
+    float pomFadeEnd = 30.0;
+    float pomFactor = 1.0 - clamp((viewDistance - pomFadeStart) / (pomFadeEnd - pomFadeStart), 0.0, 1.0);
+    
+    vec2 finalTexCoords = TexCoords;
+    if (usePOM && pomFactor > 0.01 && !isGlass)
+    {
+        // 计算切线空间视线方向
+        vec3 viewDirTangent = normalize(TangentViewPos - TangentFragPos);
+        
+        // 动态调整高度缩放 (远处减弱为0)
+        float effectiveHeightScale = heightScale * pomFactor;
+        
+        finalTexCoords = ParallaxMapping(TexCoords, viewDirTangent, effectiveHeightScale);
+        
+        // 丢弃边缘 (防止纹理重复处的伪影)
+        //if(finalTexCoords.x > 1.0 || finalTexCoords.y > 1.0 || finalTexCoords.x < 0.0 || finalTexCoords.y < 0.0)
+        //  discard; 
+    }
+
+    vec4 albedoData = materialBaseColor;
+    float metallic = materialMetallic;
+    float roughness = materialRoughness;
+    float ao = 1.0;
+    vec3 emissive = vec3(0.0);
+
+    if(useAlbedoMap) 
+    {
+        vec4 texColor = texture(albedoMap, finalTexCoords);
+        texColor.rgb = pow(texColor.rgb, vec3(2.2)); 
+        albedoData *= texColor;
+    }
+    if (gltf)
+    {
+        if(useMetallicRoughnessMap)
+        {
+            vec4 mrSample = texture(metallic_roughnessMap, finalTexCoords);
+            metallic *= mrSample.b;
+            roughness *= mrSample.g;
+        }
+        else
+        {
+            if(useMetallicMap)
+            {
+                 metallic *= texture(metallicMap, finalTexCoords).r;
+            }
+            if(useRoughnessMap)
+            {
+                roughness *= texture(roughnessMap, finalTexCoords).r;
+            }
+        }
+    }
+    else
+    {
+        if(useMetallicMap)
+        {
+            metallic *= texture(metallicMap, finalTexCoords).r;
+        }
+        if(useRoughnessMap)
+        {
+            roughness *= texture(roughnessMap, finalTexCoords).r;
+        }
+    }
+
+    if(useAOMap)
+    {
+        ao = texture(aoMap, finalTexCoords).r;
+    }
+
+    if (useEmissiveMap) 
+    {
+        emissive = texture(emissiveMap, finalTexCoords).rgb;
+        emissive = pow(emissive, vec3(2.2)); // 转换到线性空间
+        emissive *= materialEmissive;  // 乘上发光因子
+    }
+
+    // 数据归一化
+    SurfaceData surface;
+    surface.albedo = albedoData.rgb;
+    surface.alpha = albedoData.a;
+    surface.metallic = clamp(metallic, 0.0, 1.0);
+    surface.roughness = clamp(roughness, 0.01, 0.99);
+    surface.ao = clamp(ao, 0.0, 1.0);
+    surface.emissive = emissive;
+    surface.N = getNormalFromMap(finalTexCoords);
+    return surface;
+}
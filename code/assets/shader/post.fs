@@ -0,0 +1,59 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D sceneColor; // 渲染分辨率的线性 HDR 颜色（双线性过滤）
+uniform sampler2D bloomTexture; // 半分辨率泛光链上采样的结果
+uniform vec2 sourceSize;
+uniform bool upscale;         // 渲染分辨率小于窗口时用 Catmull-Rom 放大
+uniform bool useBloom;
+uniform float bloomIntensity;
+uniform int bloomLevels;      // 泛光链逐级相加，除以级数归一
+uniform float exposure;
+
+// Catmull-Rom 放大：4x4 个纹素的三次权重，合并成 9 次双线性采样（中间两列/两行各合成一次）
+// 比双线性锐利，轻微的过冲截到 0
+vec3 sampleCatmullRom(vec2 uv)
+{
+    vec2 samplePos = uv * sourceSize;
+    vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 texPos0 = (texPos1 - 1.0) / sourceSize;
+    vec2 texPos3 = (texPos1 + 2.0) / sourceSize;
+    vec2 texPos12 = (texPos1 + w2 / w12) / sourceSize;
+
+    vec3 color = vec3(0.0);
+    color += textureLod(sceneColor, vec2(texPos0.x,  texPos0.y), 0.0).rgb * w0.x * w0.y;
+    color += textureLod(sceneColor, vec2(texPos12.x, texPos0.y), 0.0).rgb * w12.x * w0.y;
+    color += textureLod(sceneColor, vec2(texPos3.x,  texPos0.y), 0.0).rgb * w3.x * w0.y;
+
+    color += textureLod(sceneColor, vec2(texPos0.x,  texPos12.y), 0.0).rgb * w0.x * w12.y;
+    color += textureLod(sceneColor, vec2(texPos12.x, texPos12.y), 0.0).rgb * w12.x * w12.y;
+    color += textureLod(sceneColor, vec2(texPos3.x,  texPos12.y), 0.0).rgb * w3.x * w12.y;
+
+    color += textureLod(sceneColor, vec2(texPos0.x,  texPos3.y), 0.0).rgb * w0.x * w3.y;
+    color += textureLod(sceneColor, vec2(texPos12.x, texPos3.y), 0.0).rgb * w12.x * w3.y;
+    color += textureLod(sceneColor, vec2(texPos3.x,  texPos3.y), 0.0).rgb * w3.x * w3.y;
+
+    return max(color, vec3(0.0));
+}
+
+// 后处理：放大到窗口、叠加泛光、曝光、Reinhard 色调映射、gamma 校正，每个窗口像素只做一次
+void main()
+{
+    vec3 color = upscale ? sampleCatmullRom(TexCoords) : texelFetch(sceneColor, ivec2(gl_FragCoord.xy), 0).rgb;
+    if (useBloom)
+        color = mix(color, textureLod(bloomTexture, TexCoords, 0.0).rgb / float(bloomLevels), bloomIntensity);
+
+    color *= exposure;
+    color = color / (color + vec3(1.0)); // Reinhard色调映射
+    color = pow(color, vec3(1.0/2.2));  // Gamma校正
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,54 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+in vec3 WorldPos;
+in vec3 Normal;
+in mat3 TBN;
+in vec3 TangentViewPos;
+in vec3 TangentFragPos;
+
+uniform vec3 camPos;
+
+#include "pbr_material.glsl"
+#include "pbr_lighting.glsl"
+#include "lightmap.glsl"
+
+uniform int pointLightCount;
+
+// 反射探针捕获（reflection_probes.h）：每帧只画一个 128 见方的面，只算漫反射
+// 静态图块直接用光照贴图；其他表面遍历全部点光源（没有分簇，带阴影图集里的阴影）再加探针环境光
+// 平行光的级联只覆盖主相机附近，捕获时不算
+void main()
+{
+    SurfaceData surface = sampleSurface();
+    vec3 albedo = surface.albedo * (1.0 - surface.metallic);
+    vec3 N = surface.N;
+    if (doubleSided && dot(N, camPos - WorldPos) < 0.0) N = -N;
+
+    vec3 baked;
+    if (sampleLightmap(baked))
+    {
+        FragColor = vec4(baked * albedo * surface.ao + surface.emissive, 1.0);
+        return;
+    }
+
+    vec3 irradiance = insideLightProbes(WorldPos) ? sampleLightProbes(WorldPos, N) : environmentLight;
+    vec3 color = irradiance * albedo * surface.ao;
+    float footprint = max(length(dFdx(WorldPos)), length(dFdy(WorldPos)));
+    for (int i = 0; i < pointLightCount; ++i)
+    {
+        PointLightData light = fetchPointLight(i);
+        vec3 toLight = light.position - WorldPos;
+        float distance = length(toLight);
+        if (distance > light.range) continue;
+        vec3 L = toLight / distance;
+        float spotFactor = spotLightFactor(L, light.direction, light.cutOff);
+        if (spotFactor == 0.0) continue;
+
+        float shadowFactor = 1.0;
+        if (light.shadowIndex >= 0)
+            shadowFactor -= calculatePointShadow(WorldPos, light.shadowIndex, vec4(light.direction, light.cutOff), light.position, light.range, N, false, false, footprint);
+        color += albedo / PI * light.color * pointLightAttenuation(distance, light.range) * spotFactor * max(dot(N, L), 0.0) * shadowFactor;
+    }
+    FragColor = vec4(color + surface.emissive, 1.0);
+}
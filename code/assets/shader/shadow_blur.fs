@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) out vec2 Moments;
+
+uniform sampler2D source;
+uniform ivec2 sourceOrigin; // 读取区域的左下角（像素）
+uniform ivec2 targetOrigin; // 输出区域的左下角（像素）
+uniform int size;           // 区域边长，读取夹在区域内，模糊不会越过面边界
+uniform ivec2 direction;    // (1, 0) 水平 / (0, 1) 垂直
+
+const float weight[5] = float[] (0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+// 矩阴影的可分离高斯模糊，阴影软硬只在生成时付一次代价
+void main()
+{
+    ivec2 local = ivec2(gl_FragCoord.xy) - targetOrigin;
+    vec2 result = texelFetch(source, sourceOrigin + local, 0).rg * weight[0];
+    for (int i = 1; i < 5; ++i)
+    {
+        ivec2 a = clamp(local + direction * i, ivec2(0), ivec2(size - 1));
+        ivec2 b = clamp(local - direction * i, ivec2(0), ivec2(size - 1));
+        result += texelFetch(source, sourceOrigin + a, 0).rg * weight[i];
+        result += texelFetch(source, sourceOrigin + b, 0).rg * weight[i];
+    }
+    Moments = result;
+}
@@ -0,0 +1,52 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+
+uniform vec3 camPos;
+
+#include "pbr_lighting.glsl"
+
+uniform sampler2D sceneDepth; // 深度预通道结果（全分辨率）
+uniform mat4 invViewProjection;
+uniform int maskScale;        // 1: 全分辨率, 2: 半分辨率
+uniform vec2 screenSize;
+
+// 屏幕空间阴影遮罩：每个遮罩纹素对应全分辨率像素 (x, y) * maskScale，由深度重建世界坐标后算一次点光源阴影
+// 通道 c 存簇内第一个 shadowIndex & 3 == c 的阴影光源，与 pbr_lighting.glsl 的 pointLighting 按同样顺序分配
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) * maskScale;
+    float depth = texelFetch(sceneDepth, pixel, 0).r;
+
+    vec2 uv = (vec2(pixel) + 0.5) / screenSize;
+    vec4 clipPos = vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProjection * clipPos;
+    vec3 P = worldPos.xyz / worldPos.w;
+
+    // 导数要在分支外求：几何法线只用于阴影偏移，footprint 换算回全分辨率像素
+    vec3 dPdx = dFdx(P);
+    vec3 dPdy = dFdy(P);
+    vec3 N = normalize(cross(dPdx, dPdy));
+    if (dot(N, camPos - P) < 0.0) N = -N;
+    float footprint = max(length(dPdx), length(dPdy)) / float(maskScale);
+
+    vec4 mask = vec4(0.0);
+    if (depth < 1.0)
+    {
+        bvec4 used = bvec4(false);
+        uvec2 range = clusterLightRange(clusterIndex(vec2(pixel) + 0.5, depth));
+        for (uint i = 0u; i < range.y; ++i)
+        {
+            PointLightData light = fetchClusterLight(range.x + i);
+            if (light.shadowIndex < 0) continue;
+            int channel = light.shadowIndex & 3;
+            if (used[channel]) continue;
+            used[channel] = true;
+
+            vec3 L = normalize(light.position - P);
+            if (length(light.position - P) > light.range || spotLightFactor(L, light.direction, light.cutOff) == 0.0) continue;
+            mask[channel] = calculatePointShadow(P, light.shadowIndex, vec4(light.direction, light.cutOff), light.position, light.range, N, false, false, footprint);
+        }
+    }
+    FragColor = mask;
+}
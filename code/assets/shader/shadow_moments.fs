@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) out vec2 Moments;
+
+uniform sampler2D depthAtlas;
+uniform ivec2 sourceOrigin; // 该面在深度图集中的左下角（像素）
+uniform ivec2 targetOrigin; // 输出区域的左下角（像素）
+
+// 矩阴影：2x2 深度纹素降采样为一阶/二阶矩（线性距离 / far_plane）
+void main()
+{
+    ivec2 base = sourceOrigin + 2 * (ivec2(gl_FragCoord.xy) - targetOrigin);
+    vec2 moments = vec2(0.0);
+    for (int y = 0; y < 2; ++y)
+    {
+        for (int x = 0; x < 2; ++x)
+        {
+            float depth = texelFetch(depthAtlas, base + ivec2(x, y), 0).r;
+            moments += vec2(depth, depth * depth);
+        }
+    }
+    Moments = moments * 0.25;
+}
@@ -7,10 +7,8 @@ uniform samplerCube environmentMap;
 
 void main()
 {
+    // 与场景一样输出线性 HDR，由后处理统一色调映射
     vec3 envColor = texture(environmentMap, localPos).rgb;
 
-    envColor = envColor / (envColor + vec3(1.0));
-    envColor = pow(envColor, vec3(1.0/2.2)); 
-
     FragColor = vec4(envColor, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D currentColor;    // 本帧场景颜色（线性 HDR，抖动后）
+uniform sampler2D historyColor;    // 上一次解析结果
+uniform sampler2D velocityTexture; // 本帧 uv - 上一帧 uv
+uniform sampler2D sceneDepth;
+uniform bool historyValid;
+uniform float historyBlend;        // 当前帧权重
+
+// HDR 下极亮的像素会主导混合结果（闪烁），按 1 / (1 + 最大分量) 压缩后再裁剪混合，输出前还原
+vec3 compressHDR(vec3 c)
+{
+    return c / (1.0 + max(c.r, max(c.g, c.b)));
+}
+
+vec3 expandHDR(vec3 c)
+{
+    return c / max(1.0 - max(c.r, max(c.g, c.b)), 1e-4);
+}
+
+vec3 rgbToYCoCg(vec3 c)
+{
+    return vec3(0.25 * c.r + 0.5 * c.g + 0.25 * c.b, 0.5 * c.r - 0.5 * c.b, -0.25 * c.r + 0.5 * c.g - 0.25 * c.b);
+}
+
+vec3 yCoCgToRgb(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// 把历史颜色沿指向包围盒中心的方向裁剪进盒内（比逐分量截断更少偏色）
+vec3 clipToBox(vec3 history, vec3 boxMin, vec3 boxMax)
+{
+    vec3 center = 0.5 * (boxMax + boxMin);
+    vec3 extent = 0.5 * (boxMax - boxMin) + 1e-4;
+    vec3 offset = history - center;
+    vec3 ratio = abs(offset / extent);
+    float maxRatio = max(ratio.x, max(ratio.y, ratio.z));
+    return maxRatio > 1.0 ? center + offset / maxRatio : history;
+}
+
+// 时间抗锯齿解析：取 3x3 邻域内最近的像素的运动向量（物体边缘的历史跟着前景走），
+// 历史按邻域在 YCoCg 空间的颜色范围裁剪后与当前帧混合；历史无效或重投影到屏幕外时只用当前帧
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(currentColor, 0);
+
+    vec3 current = vec3(0.0);
+    vec3 boxMin = vec3(1e6);
+    vec3 boxMax = vec3(-1e6);
+    float closestDepth = 1.0;
+    ivec2 closestPixel = pixel;
+    for (int y = -1; y <= 1; ++y)
+    {
+        for (int x = -1; x <= 1; ++x)
+        {
+            ivec2 p = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+            vec3 c = rgbToYCoCg(compressHDR(texelFetch(currentColor, p, 0).rgb));
+            if (x == 0 && y == 0) current = c;
+            boxMin = min(boxMin, c);
+            boxMax = max(boxMax, c);
+
+            float d = texelFetch(sceneDepth, p, 0).r;
+            if (d < closestDepth)
+            {
+                closestDepth = d;
+                closestPixel = p;
+            }
+        }
+    }
+
+    vec2 historyUV = TexCoords - texelFetch(velocityTexture, closestPixel, 0).xy;
+    if (!historyValid || any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, vec2(1.0))))
+    {
+        FragColor = vec4(expandHDR(yCoCgToRgb(current)), 1.0);
+        return;
+    }
+
+    vec3 history = clipToBox(rgbToYCoCg(compressHDR(textureLod(historyColor, historyUV, 0.0).rgb)), boxMin, boxMax);
+    FragColor = vec4(expandHDR(max(yCoCgToRgb(mix(history, current, historyBlend)), vec3(0.0))), 1.0);
+}
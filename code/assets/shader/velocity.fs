@@ -0,0 +1,21 @@
+#version 330 core
+out vec2 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D sceneDepth;
+uniform mat4 invViewProjection;  // 本帧抖动后的 VP 的逆，与深度一致
+uniform mat4 currViewProjection; // 本帧未抖动的 VP
+uniform mat4 prevViewProjection; // 上一帧未抖动的 VP
+
+// 相机运动向量：由深度重建世界坐标，投影到本帧和上一帧，输出 uv 差（本帧 - 上一帧）
+// 两边都不含抖动，静止画面的运动向量严格为 0；天空盒深度为 1，按远平面上的点处理
+void main()
+{
+    float depth = texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r;
+    vec4 worldPos = invViewProjection * vec4(TexCoords * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    worldPos /= worldPos.w;
+
+    vec4 currClip = currViewProjection * worldPos;
+    vec4 prevClip = prevViewProjection * worldPos;
+    FragColor = (currClip.xy / currClip.w - prevClip.xy / prevClip.w) * 0.5;
+}
@@ -23,6 +23,10 @@ std::vector<glm::mat3> WNormalMatrices;
 std::vector<glm::mat4> CmodelMatrices;
 std::vector<glm::mat3> CNormalMatrices;
 
+// 地面/墙体单元网格的模型空间包围盒（顶面 y=0，厚度 0.2），用于阴影投射者剔除
+const glm::vec3 TILE_BOUNDS_MIN(-0.5f, -0.2f, -0.5f);
+const glm::vec3 TILE_BOUNDS_MAX(0.5f, 0.0f, 0.5f);
+
 void BuildMatrix()
 {
 	int length = 10, width = 10, height = 3;
@@ -0,0 +1,267 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <shader.h>
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <iostream>
+
+// 分簇光照：视锥按屏幕瓦片 × 指数深度切片划分为三维簇，CPU 每帧为每个簇列出覆盖它的光源
+// 片段只遍历自己所在簇的光源，着色开销与簇内光源数有关，与场景光源总数无关
+// GPU 端布局见 light_clusters.glsl
+const int CLUSTER_X = 16;
+const int CLUSTER_Y = 9;
+const int CLUSTER_Z = 24;
+const int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+const unsigned int MAX_LIGHTS_PER_CLUSTER = 255; // 簇头里数量只占 8 位
+const int LIGHT_DATA_TEXTURE_UNIT = 14;
+const int LIGHT_CLUSTER_TEXTURE_UNIT = 15;
+
+// 参与分簇的点光源 / 聚光灯
+struct ClusterLight
+{
+	glm::vec3 position;
+	float range;
+	glm::vec3 color;
+	int shadowIndex; // 阴影立方体贴图下标，-1 表示不投射阴影
+	glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	float cutOff = 0.0f; // 聚光锥半角余弦，0 表示全向
+};
+
+struct LightClusters
+{
+	unsigned int lightBuffer = 0, lightTexture = 0;     // RGBA32F，每个光源 3 个纹素
+	unsigned int clusterBuffer = 0, clusterTexture = 0; // R32UI，簇头 + 光源索引表
+	float nearPlane = 0.1f;
+	float farPlane = 100.0f;
+
+	// 视空间簇包围盒，只在投影矩阵变化时重算
+	glm::mat4 projection = glm::mat4(0.0f);
+	std::vector<glm::vec3> clusterMin, clusterMax;
+
+	std::vector<glm::vec4> lightData;
+	std::vector<unsigned int> clusterData;
+	std::vector<std::vector<unsigned int>> clusterLists;
+
+	// 统计（printLightClusterStats 打印后清零）
+	int lightCount = 0;
+	long long totalAssignments = 0;
+	long long occupiedClusters = 0;
+	unsigned int maxPerCluster = 0;
+	long long droppedAssignments = 0; // 簇已满 MAX_LIGHTS_PER_CLUSTER 而丢掉的光源-簇对
+	int frames = 0;
+};
+LightClusters lightClusters;
+
+void buildLightClusters(const std::vector<ClusterLight>& lights, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane);
+void bindLightClusters();
+void setLightClusterUniforms(Shader& shader, int width, int height);
+void printLightClusterStats();
+
+static float clusterSliceDepth(int slice)
+{
+	return lightClusters.nearPlane * std::pow(lightClusters.farPlane / lightClusters.nearPlane, (float)slice / CLUSTER_Z);
+}
+
+// 每个簇在视空间的轴对齐包围盒（对称透视投影）
+static void computeClusterBounds(const glm::mat4& projection)
+{
+	lightClusters.projection = projection;
+	lightClusters.clusterMin.resize(CLUSTER_COUNT);
+	lightClusters.clusterMax.resize(CLUSTER_COUNT);
+
+	for (int z = 0; z < CLUSTER_Z; ++z)
+	{
+		float depthNear = clusterSliceDepth(z);
+		float depthFar = clusterSliceDepth(z + 1);
+		for (int y = 0; y < CLUSTER_Y; ++y)
+		{
+			for (int x = 0; x < CLUSTER_X; ++x)
+			{
+				glm::vec3 minPoint(FLT_MAX), maxPoint(-FLT_MAX);
+				for (int corner = 0; corner < 8; ++corner)
+				{
+					float ndcX = -1.0f + 2.0f * (x + (corner & 1)) / CLUSTER_X;
+					float ndcY = -1.0f + 2.0f * (y + ((corner >> 1) & 1)) / CLUSTER_Y;
+					float depth = (corner & 4) ? depthFar : depthNear;
+					glm::vec3 p(ndcX * depth / projection[0][0], ndcY * depth / projection[1][1], -depth);
+					minPoint = glm::min(minPoint, p);
+					maxPoint = glm::max(maxPoint, p);
+				}
+				int index = x + CLUSTER_X * (y + CLUSTER_Y * z);
+				lightClusters.clusterMin[index] = minPoint;
+				lightClusters.clusterMax[index] = maxPoint;
+			}
+		}
+	}
+}
+
+// 光源影响范围的包围球；聚光灯用圆锥的最小包围球，半角越小越紧
+static void clusterLightBounds(const ClusterLight& light, glm::vec3& center, float& radius)
+{
+	center = light.position;
+	radius = light.range;
+	if (light.cutOff <= 0.0f) return;
+	float cosHalf = light.cutOff;
+	float sinHalf = std::sqrt(1.0f - cosHalf * cosHalf);
+	if (cosHalf >= 0.70710678f)
+	{
+		// 半角不超过 45°：球过锥顶和底面圆
+		radius = light.range / (2.0f * cosHalf);
+		center = light.position + light.direction * radius;
+	}
+	else
+	{
+		// 半角更大：以底面圆为大圆
+		radius = light.range * sinHalf;
+		center = light.position + light.direction * (light.range * cosHalf);
+	}
+}
+
+static bool sphereIntersectsAABB(const glm::vec3& center, float radius, const glm::vec3& minPoint, const glm::vec3& maxPoint)
+{
+	glm::vec3 closest = glm::clamp(center, minPoint, maxPoint);
+	glm::vec3 d = closest - center;
+	return glm::dot(d, d) <= radius * radius;
+}
+
+// 为每个簇收集光源并上传到缓冲纹理
+void buildLightClusters(const std::vector<ClusterLight>& lights, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane)
+{
+	LightClusters& lc = lightClusters;
+	if (lc.lightBuffer == 0)
+	{
+		glGenBuffers(1, &lc.lightBuffer);
+		glGenBuffers(1, &lc.clusterBuffer);
+		glGenTextures(1, &lc.lightTexture);
+		glGenTextures(1, &lc.clusterTexture);
+
+		glBindBuffer(GL_TEXTURE_BUFFER, lc.lightBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4) * 3, NULL, GL_STREAM_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, lc.lightTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lc.lightBuffer);
+
+		glBindBuffer(GL_TEXTURE_BUFFER, lc.clusterBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(unsigned int) * CLUSTER_COUNT, NULL, GL_STREAM_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, lc.clusterTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, lc.clusterBuffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+	if (projection != lc.projection || nearPlane != lc.nearPlane || farPlane != lc.farPlane)
+	{
+		lc.nearPlane = nearPlane;
+		lc.farPlane = farPlane;
+		computeClusterBounds(projection);
+	}
+
+	// 光源数据
+	lc.lightData.clear();
+	for (const ClusterLight& light : lights)
+	{
+		lc.lightData.push_back(glm::vec4(light.position, light.range));
+		lc.lightData.push_back(glm::vec4(light.color, (float)light.shadowIndex));
+		lc.lightData.push_back(glm::vec4(light.direction, light.cutOff));
+	}
+	if (lc.lightData.empty()) lc.lightData.push_back(glm::vec4(0.0f)); // 缓冲不能为空
+
+	// 按切片范围缩小候选簇，再逐簇做球与包围盒相交测试
+	lc.clusterLists.resize(CLUSTER_COUNT);
+	for (auto& list : lc.clusterLists) list.clear();
+	float logRatio = std::log(farPlane / nearPlane);
+	for (unsigned int i = 0; i < lights.size(); ++i)
+	{
+		glm::vec3 worldCenter;
+		float radius;
+		clusterLightBounds(lights[i], worldCenter, radius);
+		glm::vec3 center = glm::vec3(view * glm::vec4(worldCenter, 1.0f));
+		float depthMin = -center.z - radius;
+		float depthMax = -center.z + radius;
+		if (depthMax < nearPlane || depthMin > farPlane) continue;
+
+		int sliceMin = (int)std::floor(std::log(std::max(depthMin, nearPlane) / nearPlane) / logRatio * CLUSTER_Z);
+		int sliceMax = (int)std::floor(std::log(std::min(depthMax, farPlane) / nearPlane) / logRatio * CLUSTER_Z);
+		sliceMin = std::max(sliceMin, 0);
+		sliceMax = std::min(sliceMax, CLUSTER_Z - 1);
+
+		for (int z = sliceMin; z <= sliceMax; ++z)
+		{
+			for (int xy = 0; xy < CLUSTER_X * CLUSTER_Y; ++xy)
+			{
+				int index = xy + CLUSTER_X * CLUSTER_Y * z;
+				if (!sphereIntersectsAABB(center, radius, lc.clusterMin[index], lc.clusterMax[index])) continue;
+				if (lc.clusterLists[index].size() >= MAX_LIGHTS_PER_CLUSTER)
+					lc.droppedAssignments++;
+				else
+					lc.clusterLists[index].push_back(i);
+			}
+		}
+	}
+
+	// 簇头: (索引表偏移 << 8) | 数量，索引表紧跟在所有簇头之后
+	lc.clusterData.assign(CLUSTER_COUNT, 0u);
+	for (int index = 0; index < CLUSTER_COUNT; ++index)
+	{
+		const auto& list = lc.clusterLists[index];
+		if (list.empty()) continue;
+		lc.clusterData[index] = ((unsigned int)lc.clusterData.size() << 8) | (unsigned int)list.size();
+		lc.clusterData.insert(lc.clusterData.end(), list.begin(), list.end());
+
+		lc.totalAssignments += list.size();
+		lc.occupiedClusters++;
+		lc.maxPerCluster = std::max(lc.maxPerCluster, (unsigned int)list.size());
+	}
+	lc.lightCount = (int)lights.size();
+	lc.frames++;
+
+	glBindBuffer(GL_TEXTURE_BUFFER, lc.lightBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, lc.lightData.size() * sizeof(glm::vec4), lc.lightData.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, lc.clusterBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, lc.clusterData.size() * sizeof(unsigned int), lc.clusterData.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void bindLightClusters()
+{
+	glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, lightClusters.lightTexture);
+	glActiveTexture(GL_TEXTURE0 + LIGHT_CLUSTER_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, lightClusters.clusterTexture);
+}
+
+// width/height 为着色所用帧缓冲的像素尺寸
+void setLightClusterUniforms(Shader& shader, int width, int height)
+{
+	shader.setInt("pointLightData", LIGHT_DATA_TEXTURE_UNIT);
+	shader.setInt("lightClusterData", LIGHT_CLUSTER_TEXTURE_UNIT);
+	glUniform3i(glGetUniformLocation(shader.ID, "clusterCount"), CLUSTER_X, CLUSTER_Y, CLUSTER_Z);
+	shader.setVec2("clusterTileSize", (float)width / CLUSTER_X, (float)height / CLUSTER_Y);
+	shader.setFloat("clusterNear", lightClusters.nearPlane);
+	shader.setFloat("clusterFar", lightClusters.farPlane);
+}
+
+void printLightClusterStats()
+{
+	LightClusters& lc = lightClusters;
+	if (lc.frames == 0) return;
+	double avg = lc.occupiedClusters ? (double)lc.totalAssignments / lc.occupiedClusters : 0.0;
+	std::cout << "[Clusters] lights: " << lc.lightCount
+		<< " | occupied: " << lc.occupiedClusters / lc.frames << "/" << CLUSTER_COUNT
+		<< " | avg lights per occupied cluster: " << avg
+		<< " | max: " << lc.maxPerCluster;
+	if (lc.droppedAssignments > 0)
+		std::cout << " | dropped (cluster full): " << lc.droppedAssignments / lc.frames << " per frame";
+	std::cout << std::endl;
+	lc.totalAssignments = 0;
+	lc.droppedAssignments = 0;
+	lc.occupiedClusters = 0;
+	lc.maxPerCluster = 0;
+	lc.frames = 0;
+}
+#endif
@@ -0,0 +1,187 @@
+#ifndef CONE_MAP_H
+#define CONE_MAP_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <cstdint>
+
+// 锥步进视差（cone step mapping）：对高度图（值即深度，1 为最深）的每个纹素求一个以其表面点为顶点、向上张开、
+// 内部没有任何更高纹素的圆锥，着色时沿视线每步直接跳到锥面，比逐层线性步进少得多的采样就能贴近表面
+// 生成的纹理 r: 深度, g: sqrt(锥宽高比 / CONE_RATIO_MAX)，开平方给小锥更多精度
+// 生成较慢，结果缓存在源图旁边（height.png -> height.cone），源图更新后自动重建
+const float CONE_RATIO_MAX = 1.0f;
+const uint32_t CONE_MAP_MAGIC = 0x454E4F43; // "CONE"
+const uint32_t CONE_MAP_VERSION = 1;
+
+std::vector<uint8_t> buildConeMap(const std::vector<float>& depth, int width, int height);
+unsigned int loadConeMap(const char* heightPath);
+
+// 点 p 到区间 [lo, hi] 在周期 period 上的最近距离（纹理平铺，锥要跨越边界）
+static float wrappedAxisDistance(float p, float lo, float hi, float period)
+{
+	float best = period;
+	for (int k = -1; k <= 1; ++k)
+	{
+		float l = lo + k * period;
+		float h = hi + k * period;
+		best = std::min(best, p < l ? l - p : (p > h ? p - h : 0.0f));
+	}
+	return best;
+}
+
+// 锥宽高比 = min(到更高纹素的 uv 距离 / 深度差)；用最小深度金字塔做四叉树剪枝，整块的下界不小于当前结果就跳过
+// 返回 RG8 数据
+std::vector<uint8_t> buildConeMap(const std::vector<float>& depth, int width, int height)
+{
+	std::vector<std::vector<float>> levels{ depth };
+	std::vector<glm::ivec2> sizes{ glm::ivec2(width, height) };
+	while (sizes.back().x > 1 || sizes.back().y > 1)
+	{
+		glm::ivec2 prev = sizes.back();
+		glm::ivec2 size((prev.x + 1) / 2, (prev.y + 1) / 2);
+		const std::vector<float>& src = levels.back();
+		std::vector<float> level(size.x * size.y);
+		for (int y = 0; y < size.y; ++y)
+			for (int x = 0; x < size.x; ++x)
+			{
+				float m = 1.0f;
+				for (int i = 0; i < 4; ++i)
+				{
+					int sx = std::min(2 * x + (i & 1), prev.x - 1);
+					int sy = std::min(2 * y + (i >> 1), prev.y - 1);
+					m = std::min(m, src[sy * prev.x + sx]);
+				}
+				level[y * size.x + x] = m;
+			}
+		levels.push_back(std::move(level));
+		sizes.push_back(size);
+	}
+
+	struct Node
+	{
+		int level, x, y;
+		float bound; // 块内纹素锥宽高比的下界
+	};
+	std::vector<Node> stack;
+	std::vector<uint8_t> cone((size_t)width * height * 2);
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			float sourceDepth = depth[y * width + x];
+			float best = CONE_RATIO_MAX;
+			glm::vec2 p(x + 0.5f, y + 0.5f);
+
+			stack.clear();
+			stack.push_back({ (int)levels.size() - 1, 0, 0, 0.0f });
+			while (!stack.empty())
+			{
+				Node node = stack.back();
+				stack.pop_back();
+				if (node.bound >= best) continue;
+				if (node.level == 0)
+				{
+					best = node.bound; // 单个纹素，下界即精确值
+					continue;
+				}
+
+				int level = node.level - 1;
+				int span = 1 << level;
+				glm::ivec2 size = sizes[level];
+				Node children[4];
+				int count = 0;
+				for (int i = 0; i < 4; ++i)
+				{
+					int cx = node.x * 2 + (i & 1);
+					int cy = node.y * 2 + (i >> 1);
+					if (cx >= size.x || cy >= size.y) continue;
+					float minDepth = levels[level][cy * size.x + cx];
+					if (minDepth >= sourceDepth) continue; // 块内没有更高的纹素
+					float dx = wrappedAxisDistance(p.x, cx * span + 0.5f, std::min((cx + 1) * span, width) - 0.5f, (float)width);
+					float dy = wrappedAxisDistance(p.y, cy * span + 0.5f, std::min((cy + 1) * span, height) - 0.5f, (float)height);
+					float bound = glm::length(glm::vec2(dx / width, dy / height)) / (sourceDepth - minDepth);
+					if (bound < best) children[count++] = { level, cx, cy, bound };
+				}
+				// 下界小的后入栈先处理，尽早收紧 best
+				std::sort(children, children + count, [](const Node& a, const Node& b) { return a.bound > b.bound; });
+				for (int i = 0; i < count; ++i) stack.push_back(children[i]);
+			}
+
+			size_t index = (size_t)(y * width + x) * 2;
+			cone[index] = (uint8_t)glm::round(glm::clamp(sourceDepth, 0.0f, 1.0f) * 255.0f);
+			cone[index + 1] = (uint8_t)glm::floor(glm::sqrt(best / CONE_RATIO_MAX) * 255.0f); // 向下取整，量化后仍是保守的
+		}
+	}
+	return cone;
+}
+
+// 读取或生成 heightPath 对应的锥图并上传为 RG8 纹理（mipmap，平铺），失败时返回 0
+unsigned int loadConeMap(const char* heightPath)
+{
+	namespace fs = std::filesystem;
+	fs::path sourcePath(heightPath);
+	fs::path cachePath = fs::path(sourcePath).replace_extension(".cone");
+
+	int width = 0, height = 0;
+	std::vector<uint8_t> cone;
+	std::error_code ec;
+	if (fs::exists(cachePath, ec) && fs::last_write_time(cachePath, ec) >= fs::last_write_time(sourcePath, ec) && !ec)
+	{
+		std::ifstream file(cachePath, std::ios::binary);
+		uint32_t header[4] = {};
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (file && header[0] == CONE_MAP_MAGIC && header[1] == CONE_MAP_VERSION)
+		{
+			width = (int)header[2];
+			height = (int)header[3];
+			cone.resize((size_t)width * height * 2);
+			file.read(reinterpret_cast<char*>(cone.data()), cone.size());
+			if (!file) cone.clear();
+		}
+	}
+
+	if (cone.empty())
+	{
+		int components;
+		stbi_us* data = stbi_load_16(heightPath, &width, &height, &components, 1);
+		if (!data)
+		{
+			std::cout << "Texture failed to load at path: " << heightPath << std::endl;
+			return 0;
+		}
+		std::vector<float> depth((size_t)width * height);
+		for (size_t i = 0; i < depth.size(); ++i) depth[i] = data[i] / 65535.0f;
+		stbi_image_free(data);
+
+		std::cout << "Building cone map for " << heightPath << " ..." << std::endl;
+		cone = buildConeMap(depth, width, height);
+
+		std::ofstream file(cachePath, std::ios::binary);
+		uint32_t header[4] = { CONE_MAP_MAGIC, CONE_MAP_VERSION, (uint32_t)width, (uint32_t)height };
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(cone.data()), cone.size());
+		if (!file) std::cout << "Failed to write cone map cache: " << cachePath.string() << std::endl;
+	}
+
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, width, height, 0, GL_RG, GL_UNSIGNED_BYTE, cone.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	return textureID;
+}
+#endif
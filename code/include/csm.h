@@ -0,0 +1,121 @@
+#ifndef CSM_H
+#define CSM_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "frustum.h"
+
+#include <iostream>
+
+// 平行光级联阴影（CSM）：相机视锥按距离切成 CSM_CASCADES 段，每段一张正交阴影贴图，存在同一个纹理数组里
+// 每段用包围球拟合（边长不随相机旋转变化）并把中心对齐到纹素网格，相机移动时阴影边缘不会闪烁
+const int CSM_CASCADES = 4;                 // 与 pbr_lighting.glsl 的 MAX_CASCADES 一致
+const int CSM_RESOLUTION = 2048;
+const float CSM_MAX_DISTANCE = 60.0f;       // 超出该距离不再有平行光阴影
+const float CSM_SPLIT_LAMBDA = 0.75f;       // 对数/均匀切分的混合系数
+const float CSM_CASTER_DEPTH = 50.0f;       // 向光源方向延伸的距离，包含级联外但能投影进来的物体
+
+struct CascadedShadowMap
+{
+	unsigned int fbo = 0;
+	unsigned int depthArray = 0;
+	glm::mat4 lightMatrices[CSM_CASCADES];  // 光源 projection * view
+	glm::mat4 lightViews[CSM_CASCADES];
+	glm::mat4 lightProjections[CSM_CASCADES];
+	Frustum frusta[CSM_CASCADES];          // 投射者剔除用
+	float texelSizes[CSM_CASCADES];        // 每级一个纹素的世界尺寸，用于法线偏移
+	float splits[CSM_CASCADES + 1];
+};
+CascadedShadowMap cascadedShadowMap;
+
+void ensureCascadedShadowMap();
+void updateCascades(const glm::mat4& view, float fovy, float aspect, float cameraNear, const glm::vec3& lightDirection);
+
+void ensureCascadedShadowMap()
+{
+	if (cascadedShadowMap.fbo != 0) return;
+
+	glGenFramebuffers(1, &cascadedShadowMap.fbo);
+	glGenTextures(1, &cascadedShadowMap.depthArray);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, cascadedShadowMap.depthArray);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, CSM_RESOLUTION, CSM_RESOLUTION, CSM_CASCADES,
+		0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	// 比较模式 + 线性过滤：每次采样就是一次硬件 2x2 PCF
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, cascadedShadowMap.fbo);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cascadedShadowMap.depthArray, 0, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER:: Cascaded shadow map FBO incomplete!" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// 每帧按相机重新拟合各级联
+void updateCascades(const glm::mat4& view, float fovy, float aspect, float cameraNear, const glm::vec3& lightDirection)
+{
+	CascadedShadowMap& csm = cascadedShadowMap;
+
+	// 实用切分：对数切分与均匀切分按 CSM_SPLIT_LAMBDA 混合
+	csm.splits[0] = cameraNear;
+	for (int i = 1; i <= CSM_CASCADES; ++i)
+	{
+		float t = (float)i / CSM_CASCADES;
+		float logSplit = cameraNear * glm::pow(CSM_MAX_DISTANCE / cameraNear, t);
+		float uniformSplit = cameraNear + (CSM_MAX_DISTANCE - cameraNear) * t;
+		csm.splits[i] = glm::mix(uniformSplit, logSplit, CSM_SPLIT_LAMBDA);
+	}
+
+	glm::vec3 dir = glm::normalize(lightDirection);
+	glm::vec3 up = glm::abs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), dir, up); // 原点固定，纹素网格才不随相机平移
+	glm::mat4 invView = glm::inverse(view);
+
+	for (int c = 0; c < CSM_CASCADES; ++c)
+	{
+		// 该段视锥的 8 个角（世界空间）
+		glm::mat4 invSlice = invView * glm::inverse(glm::perspective(fovy, aspect, csm.splits[c], csm.splits[c + 1]));
+		glm::vec3 corners[8];
+		glm::vec3 center(0.0f);
+		for (int i = 0; i < 8; ++i)
+		{
+			glm::vec4 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+			glm::vec4 world = invSlice * ndc;
+			corners[i] = glm::vec3(world) / world.w;
+			center += corners[i] / 8.0f;
+		}
+		float radius = 0.0f;
+		for (int i = 0; i < 8; ++i)
+			radius = glm::max(radius, glm::length(corners[i] - center));
+		radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+		// 光源空间中心对齐到纹素
+		float texelSize = 2.0f * radius / CSM_RESOLUTION;
+		glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+		lightCenter.x = glm::floor(lightCenter.x / texelSize) * texelSize;
+		lightCenter.y = glm::floor(lightCenter.y / texelSize) * texelSize;
+
+		// 光源看向 -z：近平面向光源方向多留 CSM_CASTER_DEPTH，级联外的遮挡物也能投影进来
+		glm::mat4 lightProjection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+			lightCenter.y - radius, lightCenter.y + radius,
+			-lightCenter.z - radius - CSM_CASTER_DEPTH, -lightCenter.z + radius);
+
+		csm.lightViews[c] = lightView;
+		csm.lightProjections[c] = lightProjection;
+		csm.lightMatrices[c] = lightProjection * lightView;
+		csm.frusta[c] = Frustum(csm.lightMatrices[c]);
+		csm.texelSizes[c] = texelSize;
+	}
+}
+#endif
@@ -0,0 +1,77 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// 视锥体：从 projection * view 中提取六个裁剪平面（Gribb/Hartmann），平面法线指向视锥体内部
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	// 全零平面：任何包围盒都不会被排除
+	Frustum()
+	{
+		for (int i = 0; i < 6; ++i) planes[i] = glm::vec4(0.0f);
+	}
+
+	Frustum(const glm::mat4& viewProjection)
+	{
+		glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+		planes[0] = row3 + row0; // 左
+		planes[1] = row3 - row0; // 右
+		planes[2] = row3 + row1; // 下
+		planes[3] = row3 - row1; // 上
+		planes[4] = row3 + row2; // 近
+		planes[5] = row3 - row2; // 远
+		for (int i = 0; i < 6; ++i)
+		{
+			planes[i] /= glm::length(glm::vec3(planes[i]));
+		}
+	}
+
+	// 世界空间 AABB 测试：只要有一个平面把包围盒完全排除在外就剔除（保守测试）
+	bool intersectsAABB(const glm::vec3& minP, const glm::vec3& maxP) const
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			glm::vec3 n = glm::vec3(planes[i]);
+			glm::vec3 p(n.x >= 0.0f ? maxP.x : minP.x,
+				n.y >= 0.0f ? maxP.y : minP.y,
+				n.z >= 0.0f ? maxP.z : minP.z);
+			if (glm::dot(n, p) + planes[i].w < 0.0f) return false;
+		}
+		return true;
+	}
+
+	bool intersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) return false;
+		}
+		return true;
+	}
+};
+
+// 把局部 AABB 变换到世界空间（Arvo 方法，结果仍为轴对齐包围盒）
+inline void transformAABB(const glm::mat4& m, const glm::vec3& localMin, const glm::vec3& localMax, glm::vec3& outMin, glm::vec3& outMax)
+{
+	glm::vec3 translation = glm::vec3(m[3]);
+	outMin = translation;
+	outMax = translation;
+	for (int col = 0; col < 3; ++col)
+	{
+		for (int row = 0; row < 3; ++row)
+		{
+			float a = m[col][row] * localMin[col];
+			float b = m[col][row] * localMax[col];
+			outMin[row] += glm::min(a, b);
+			outMax[row] += glm::max(a, b);
+		}
+	}
+}
+#endif
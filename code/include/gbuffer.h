@@ -0,0 +1,76 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <shader.h>
+#include "render_graph.h"
+
+#include <vector>
+
+// 延迟渲染的 G-buffer（布局见 gbuffer.glsl），都是渲染图的临时纹理
+// 不透明物体先把表面属性写进这里，之后一次全屏光照通道把结果写回场景渲染目标
+struct GBufferTargets
+{
+	RGHandle albedo = RG_NONE;   // RGBA8
+	RGHandle normal = RG_NONE;   // RG16，八面体法线
+	RGHandle material = RG_NONE; // RGBA8，金属度/粗糙度/AO/标记
+	RGHandle emissive = RG_NONE; // R11F_G11F_B10F
+	RGHandle depth = RG_NONE;    // 24 位深度
+
+	std::vector<RGHandle> colors() const { return { albedo, normal, material, emissive }; }
+};
+
+GBufferTargets createGBufferTargets(int width, int height);
+void clearGBuffer();
+void renderDeferredLighting(Shader& lightingShader, const glm::mat4& viewProjection, const GBufferTargets& gbuffer);
+
+static RGHandle createGBufferTexture(const char* name, GLenum internalFormat, int width, int height)
+{
+	RGTextureDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.internalFormat = internalFormat;
+	return rgCreateTexture(name, desc);
+}
+
+// 按渲染分辨率声明本帧的 G-buffer
+GBufferTargets createGBufferTargets(int width, int height)
+{
+	GBufferTargets gbuffer;
+	gbuffer.albedo = createGBufferTexture("gbuffer albedo", GL_RGBA8, width, height);
+	gbuffer.normal = createGBufferTexture("gbuffer normal", GL_RG16, width, height);
+	gbuffer.material = createGBufferTexture("gbuffer material", GL_RGBA8, width, height);
+	gbuffer.emissive = createGBufferTexture("gbuffer emissive", GL_R11F_G11F_B10F, width, height);
+	gbuffer.depth = createGBufferTexture("gbuffer depth", GL_DEPTH_COMPONENT24, width, height);
+	return gbuffer;
+}
+
+// 几何通道之前：清空已绑定的 G-buffer（临时纹理的内容是上一个使用者留下的）
+void clearGBuffer()
+{
+	const float clearValue[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 4; i++)
+		glClearBufferfv(GL_COLOR, i, clearValue);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+// 光照通道（图已绑定场景渲染目标）：全屏计算光照并写回深度（GL_ALWAYS，背景像素在着色器里丢弃）
+// G-buffer 占用 3~7 号纹理单元，IBL(0~2) 与阴影贴图(10+) 的绑定沿用前向通道
+void renderDeferredLighting(Shader& lightingShader, const glm::mat4& viewProjection, const GBufferTargets& gbuffer)
+{
+	lightingShader.use();
+	lightingShader.setMat4("invViewProjection", glm::inverse(viewProjection));
+	glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, rgTexture(gbuffer.albedo));
+	glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, rgTexture(gbuffer.normal));
+	glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, rgTexture(gbuffer.material));
+	glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, rgTexture(gbuffer.emissive));
+	glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, rgTexture(gbuffer.depth));
+
+	glDepthFunc(GL_ALWAYS);
+	renderQuad();
+	glDepthFunc(GL_LESS);
+}
+#endif
@@ -0,0 +1,91 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+
+// GPU 通道计时：GL_TIME_ELAPSED 查询放在环形缓冲里，隔几帧再取结果，不让 CPU 等 GPU
+// 同一时刻只能有一个 GL_TIME_ELAPSED 查询，各通道的计时不能嵌套
+struct GpuTimer
+{
+	static const int LATENCY = 4;
+	unsigned int queries[LATENCY] = { 0 };
+	bool pending[LATENCY] = { false };
+	int next = 0;
+
+	double totalMs = 0.0; // 上次打印以来的累计
+	int samples = 0;
+
+	double lastMs = 0.0; // 最近收回的一次结果，供自适应预算使用
+	bool fresh = false;
+};
+std::map<std::string, GpuTimer> gpuTimers;
+static GpuTimer* activeGpuTimer = nullptr;
+
+void beginGpuTimer(const std::string& name);
+void endGpuTimer();
+void printGpuTimers();
+bool takeGpuTimerResult(const std::string& name, double& ms);
+
+void beginGpuTimer(const std::string& name)
+{
+	GpuTimer& timer = gpuTimers[name];
+	if (timer.queries[0] == 0) glGenQueries(GpuTimer::LATENCY, timer.queries);
+
+	// 复用查询对象前先收回它上一轮的结果
+	int slot = timer.next;
+	if (timer.pending[slot])
+	{
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(timer.queries[slot], GL_QUERY_RESULT, &elapsed);
+		timer.totalMs += elapsed / 1.0e6;
+		timer.samples++;
+		timer.lastMs = elapsed / 1.0e6;
+		timer.fresh = true;
+		timer.pending[slot] = false;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, timer.queries[slot]);
+	activeGpuTimer = &timer;
+}
+
+void endGpuTimer()
+{
+	if (!activeGpuTimer) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	activeGpuTimer->pending[activeGpuTimer->next] = true;
+	activeGpuTimer->next = (activeGpuTimer->next + 1) % GpuTimer::LATENCY;
+	activeGpuTimer = nullptr;
+}
+
+// 取出该通道最近收回的结果，每个结果只返回一次；结果对应的是 LATENCY 次计时之前的那次
+bool takeGpuTimerResult(const std::string& name, double& ms)
+{
+	auto it = gpuTimers.find(name);
+	if (it == gpuTimers.end() || !it->second.fresh) return false;
+	ms = it->second.lastMs;
+	it->second.fresh = false;
+	return true;
+}
+
+// 打印上次调用以来各通道的平均耗时，然后清零
+void printGpuTimers()
+{
+	bool any = false;
+	for (auto& entry : gpuTimers)
+	{
+		GpuTimer& timer = entry.second;
+		if (timer.samples == 0) continue;
+		std::cout << (any ? " | " : "[GPU] ") << entry.first << ": "
+			<< std::fixed << std::setprecision(2) << timer.totalMs / timer.samples << " ms";
+		timer.totalMs = 0.0;
+		timer.samples = 0;
+		any = true;
+	}
+	if (any) std::cout << std::defaultfloat << std::endl;
+}
+#endif
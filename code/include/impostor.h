@@ -0,0 +1,189 @@
+#ifndef IMPOSTOR_H
+#define IMPOSTOR_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <shader.h>
+#include <model.h>
+
+#include <vector>
+#include <iostream>
+
+// 八面体替身：把模型从上半球的一组方向烘焙进图集，远处用一张公告板代替整个模型
+struct Impostor
+{
+	unsigned int albedoAtlas = 0; // rgb: 基础色, a: 覆盖率
+	unsigned int normalAtlas = 0; // rgb: 模型空间法线
+	unsigned int depthAtlas = 0;  // r: 深度, g: 粗糙度
+	int gridSize = 0;             // 图集每边的帧数
+	int frameSize = 0;            // 每帧的像素边长
+	glm::vec3 center = glm::vec3(0.0f); // 模型空间包围球
+	float radius = 0.0f;
+
+	std::vector<glm::mat4> instances; // 本帧以替身绘制的物体模型矩阵
+};
+
+const int IMPOSTOR_GRID = 8;
+const int IMPOSTOR_FRAME_SIZE = 128;
+const float IMPOSTOR_DISTANCE = 25.0f; // 超过该距离切换为替身
+
+glm::vec3 hemiOctDecode(glm::vec2 e);
+bool impostorUpright(const glm::mat4& modelMatrix);
+Impostor* bakeImpostor(Model& model, Shader& bakeShader, int gridSize = IMPOSTOR_GRID, int frameSize = IMPOSTOR_FRAME_SIZE);
+void renderImpostors(const std::vector<Impostor*>& impostors, Shader& impostorShader);
+
+// 半球八面体映射（y 轴向上），e 属于 [-1, 1]^2，与 impostor.fs 保持一致
+glm::vec3 hemiOctDecode(glm::vec2 e)
+{
+	glm::vec2 t = glm::vec2(e.x + e.y, e.x - e.y) * 0.5f;
+	return glm::normalize(glm::vec3(t.x, 1.0f - std::abs(t.x) - std::abs(t.y), t.y));
+}
+
+// 只烘焙了上半球，模型的上方向必须仍然朝上才能用替身
+bool impostorUpright(const glm::mat4& modelMatrix)
+{
+	return glm::normalize(glm::vec3(modelMatrix[1])).y > 0.99f;
+}
+
+static unsigned int createImpostorAtlas(GLenum internalFormat, GLenum format, GLenum type, int size)
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size, size, 0, format, type, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	return texture;
+}
+
+// 烘焙替身图集：每帧是一个沿半球方向的正交视图，视口覆盖包围球
+Impostor* bakeImpostor(Model& model, Shader& bakeShader, int gridSize, int frameSize)
+{
+	Impostor* impostor = new Impostor();
+	impostor->gridSize = gridSize;
+	impostor->frameSize = frameSize;
+	impostor->center = model.boundsCenter();
+	impostor->radius = model.boundsRadius();
+
+	int atlasSize = gridSize * frameSize;
+	impostor->albedoAtlas = createImpostorAtlas(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, atlasSize);
+	impostor->normalAtlas = createImpostorAtlas(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, atlasSize);
+	impostor->depthAtlas = createImpostorAtlas(GL_RG16F, GL_RG, GL_FLOAT, atlasSize);
+
+	unsigned int bakeFBO, bakeRBO;
+	glGenFramebuffers(1, &bakeFBO);
+	glGenRenderbuffers(1, &bakeRBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, bakeFBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, bakeRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasSize, atlasSize);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, bakeRBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, impostor->albedoAtlas, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, impostor->normalAtlas, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, impostor->depthAtlas, 0);
+	unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, attachments);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER:: Impostor bake FBO incomplete!" << std::endl;
+	}
+
+	GLint oldViewport[4];
+	glGetIntegerv(GL_VIEWPORT, oldViewport);
+	GLboolean oldBlend = glIsEnabled(GL_BLEND);
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// 相机放在两倍半径处，近/远平面夹住包围球，深度在 [0,1] 内线性分布
+	float r = impostor->radius;
+	glm::mat4 projection = glm::ortho(-r, r, -r, r, r, 3.0f * r);
+	bakeShader.use();
+	bakeShader.setMat4("projection", projection);
+
+	for (int y = 0; y < gridSize; ++y)
+	{
+		for (int x = 0; x < gridSize; ++x)
+		{
+			glm::vec3 dir = hemiOctDecode(glm::vec2(x, y) / float(gridSize - 1) * 2.0f - 1.0f);
+			glm::vec3 up = std::abs(dir.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			bakeShader.setMat4("view", glm::lookAt(impostor->center + dir * 2.0f * r, impostor->center, up));
+
+			glViewport(x * frameSize, y * frameSize, frameSize, frameSize);
+			model.Draw(bakeShader);
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteRenderbuffers(1, &bakeRBO);
+	glDeleteFramebuffers(1, &bakeFBO);
+	glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+	if (oldBlend) glEnable(GL_BLEND);
+
+	return impostor;
+}
+
+// 替身公告板：每种替身一次实例化绘制，三角形数与书架上的模型数量无关
+static unsigned int impostorVAO = 0;
+static unsigned int impostorVBO = 0;
+static unsigned int impostorInstanceVBO = 0;
+
+void renderImpostors(const std::vector<Impostor*>& impostors, Shader& impostorShader)
+{
+	if (impostorVAO == 0)
+	{
+		float corners[] = {
+			-1.0f, -1.0f,
+			 1.0f, -1.0f,
+			-1.0f,  1.0f,
+			 1.0f,  1.0f,
+		};
+		glGenVertexArrays(1, &impostorVAO);
+		glGenBuffers(1, &impostorVBO);
+		glGenBuffers(1, &impostorInstanceVBO);
+
+		glBindVertexArray(impostorVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, impostorVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, impostorInstanceVBO);
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			glEnableVertexAttribArray(4 + i);
+			glVertexAttribPointer(4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+			glVertexAttribDivisor(4 + i, 1);
+		}
+		glBindVertexArray(0);
+	}
+
+	impostorShader.use();
+	glBindVertexArray(impostorVAO);
+	for (Impostor* impostor : impostors)
+	{
+		if (impostor->instances.empty()) continue;
+
+		glBindBuffer(GL_ARRAY_BUFFER, impostorInstanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, impostor->instances.size() * sizeof(glm::mat4), impostor->instances.data(), GL_STREAM_DRAW);
+
+		glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, impostor->albedoAtlas);
+		glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, impostor->normalAtlas);
+		glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, impostor->depthAtlas);
+		impostorShader.setInt("gridSize", impostor->gridSize);
+		impostorShader.setVec3("boundsCenter", impostor->center);
+		impostorShader.setFloat("boundsRadius", impostor->radius);
+
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)impostor->instances.size());
+		impostor->instances.clear();
+	}
+	glBindVertexArray(0);
+}
+#endif
@@ -0,0 +1,661 @@
+#ifndef LIGHT_PROBES_H
+#define LIGHT_PROBES_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <shader.h>
+#include <mesh.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cfloat>
+
+// 烘焙的辐照度探针网格：图书馆内部按固定间距摆一个三维网格，每个探针存 L2 球谐（9 组 RGB 系数）
+// 离线在 CPU 上多线程光线追踪：每个探针向球面均匀发射光线，命中表面时算点光源的直接光（带阴影光线），
+// 未命中时取天空（辐照度立方体贴图）；第二次反弹用上一轮的探针本身近似命中点的间接光
+// 结果缓存到文件，由 --bake 启动参数单独烘焙；正常启动只读缓存，场景几何/灯光变化后（哈希不一致）不使用探针
+// 运行时 pbr_lighting.glsl 三线性插值探针
+// 系数已乘余弦卷积并除以 π，求值结果与 irradianceMap 同一约定（漫反射 = 结果 * albedo）
+const uint32_t LIGHT_PROBE_MAGIC = 0x52504853; // "SHPR"
+const uint32_t LIGHT_PROBE_VERSION = 1;
+const int LIGHT_PROBE_SH_COUNT = 9;
+const int LIGHT_PROBE_TEXTURE_UNIT = 16; // 0~15 都已占用，需要 GL_MAX_TEXTURE_IMAGE_UNITS > 16
+// 单元不够或没有烘焙结果时不创建纹理，采样器改指 brdfLUT 所在的 2 号单元：同一程序里不同类型的采样器不能指向同一单元，
+// 所以探针纹理用二维而不是三维（0~15 没有三维采样器可以共用）
+const int LIGHT_PROBE_FALLBACK_UNIT = 2;
+const float LIGHT_PROBE_SPACING = 2.5f;
+const int LIGHT_PROBE_RAYS = 256;
+const int LIGHT_PROBE_BOUNCES = 2;
+const float LIGHT_PROBE_BURIED_RATIO = 0.25f; // 命中背面的光线超过该比例，认为探针埋在几何体里，用邻居填充
+const float LIGHT_PROBE_NORMAL_BIAS = 0.3f;   // 采样点沿法线偏移，减少墙后探针的漏光
+const float LIGHT_PROBE_SKY_MAX = 0.5f;       // 天空亮度上限，与 ambientLighting 中对 irradianceMap 的限制一致
+
+struct ProbeTriangle
+{
+	glm::vec3 v0, e1, e2;
+	glm::vec3 normal; // 按绕序的几何法线（未归一化为 0 的退化三角形已丢弃）
+	glm::vec3 albedo;
+};
+
+// BVH 节点：count > 0 为叶子（triangles[start, start + count)），否则左孩子紧跟其后、右孩子为 right
+struct ProbeBVHNode
+{
+	glm::vec3 boundsMin, boundsMax;
+	int start = 0;
+	int count = 0;
+	int right = 0;
+};
+
+struct ProbeScene
+{
+	std::vector<ProbeTriangle> triangles;
+	std::vector<ProbeBVHNode> nodes;
+};
+
+struct ProbeLight
+{
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec3 direction;
+	float cutOff; // 0 表示全向
+	float range;
+};
+
+// 天空：读回的立方体贴图（面顺序 +X -X +Y -Y +Z -Z）
+struct ProbeSky
+{
+	int size = 0;
+	std::vector<glm::vec3> faces[6];
+};
+
+struct LightProbeGrid
+{
+	glm::ivec3 counts = glm::ivec3(0);
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	std::vector<glm::vec3> coefficients; // 探针 (z * ny + y) * nx + x 的第 i 个系数在 [探针 * 9 + i]
+	unsigned int texture = 0; // RGB16F 二维纹理 (9 * nx, ny * nz)，第 i 个系数占 x 方向第 i 段，第 z 层占 y 方向第 z 段
+	bool enabled = true;
+};
+LightProbeGrid lightProbeGrid;
+
+void initLightProbeGrid(LightProbeGrid& grid, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+void addProbeMesh(ProbeScene& scene, const Mesh& mesh, const glm::mat4& model, const glm::vec3& albedo);
+void addProbeBox(ProbeScene& scene, const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& albedo);
+glm::vec3 averageTextureColor(unsigned int texture);
+ProbeSky readProbeSky(unsigned int cubemap);
+void buildProbeBVH(ProbeScene& scene);
+void bakeLightProbes(LightProbeGrid& grid, const ProbeScene& scene, const std::vector<ProbeLight>& lights, const ProbeSky& sky);
+uint32_t lightProbeSceneHash(const LightProbeGrid& grid, const ProbeScene& scene, const std::vector<ProbeLight>& lights);
+bool loadLightProbes(LightProbeGrid& grid, const char* path, uint32_t hash);
+void saveLightProbes(const LightProbeGrid& grid, const char* path, uint32_t hash);
+void uploadLightProbes(LightProbeGrid& grid);
+void setLightProbeUniforms(Shader& shader);
+void bindLightProbes();
+
+// 探针在 [boundsMin, boundsMax] 内按 LIGHT_PROBE_SPACING 均匀分布（两端都有探针）
+void initLightProbeGrid(LightProbeGrid& grid, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	grid.boundsMin = boundsMin;
+	grid.boundsMax = boundsMax;
+	grid.counts = glm::max(glm::ivec3(glm::round((boundsMax - boundsMin) / LIGHT_PROBE_SPACING)) + 1, glm::ivec3(2));
+	grid.coefficients.assign((size_t)grid.counts.x * grid.counts.y * grid.counts.z * LIGHT_PROBE_SH_COUNT, glm::vec3(0.0f));
+}
+
+static void addProbeTriangle(ProbeScene& scene, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& albedo)
+{
+	ProbeTriangle triangle;
+	triangle.v0 = a;
+	triangle.e1 = b - a;
+	triangle.e2 = c - a;
+	glm::vec3 normal = glm::cross(triangle.e1, triangle.e2);
+	float length = glm::length(normal);
+	if (!(length > 1e-12f)) return;
+	triangle.normal = normal / length;
+	triangle.albedo = albedo;
+	scene.triangles.push_back(triangle);
+}
+
+// 网格变换到世界空间后加入场景，albedo 为整个网格的平均反照率（线性）
+void addProbeMesh(ProbeScene& scene, const Mesh& mesh, const glm::mat4& model, const glm::vec3& albedo)
+{
+	std::vector<glm::vec3> positions(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.vertices.size(); ++i)
+		positions[i] = glm::vec3(model * glm::vec4(mesh.vertices[i].Position, 1.0f));
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		addProbeTriangle(scene, positions[mesh.indices[i]], positions[mesh.indices[i + 1]], positions[mesh.indices[i + 2]], albedo);
+}
+
+// 地面/墙体单元是长方体，按 12 个外向三角形加入
+void addProbeBox(ProbeScene& scene, const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& albedo)
+{
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; ++i)
+	{
+		glm::vec3 local((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+		corners[i] = glm::vec3(model * glm::vec4(local, 1.0f));
+	}
+	// 每个面 4 个角按外法线逆时针排列
+	const int faces[6][4] = {
+		{ 0, 4, 6, 2 }, { 1, 3, 7, 5 }, // -X, +X
+		{ 0, 1, 5, 4 }, { 2, 6, 7, 3 }, // -Y, +Y
+		{ 0, 2, 3, 1 }, { 4, 5, 7, 6 }, // -Z, +Z
+	};
+	// 镜像变换（行列式为负）会翻转绕序
+	bool mirrored = glm::determinant(glm::mat3(model)) < 0.0f;
+	for (const auto& face : faces)
+	{
+		const glm::vec3& a = corners[face[0]];
+		const glm::vec3& b = corners[mirrored ? face[3] : face[1]];
+		const glm::vec3& c = corners[face[2]];
+		const glm::vec3& d = corners[mirrored ? face[1] : face[3]];
+		addProbeTriangle(scene, a, b, c, albedo);
+		addProbeTriangle(scene, a, c, d, albedo);
+	}
+}
+
+// 读最小一级 mipmap 得到纹理平均颜色，按 gamma 2.2 转到线性（与 pbr_material.glsl 一致）
+glm::vec3 averageTextureColor(unsigned int texture)
+{
+	int width = 0, height = 0;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	if (width <= 0 || height <= 0) return glm::vec3(1.0f);
+
+	int level = (int)std::floor(std::log2((float)std::max(width, height)));
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+	std::vector<glm::vec4> pixels((size_t)std::max(width, 1) * std::max(height, 1));
+	glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_FLOAT, pixels.data());
+
+	glm::vec3 sum(0.0f);
+	for (const glm::vec4& pixel : pixels) sum += glm::vec3(pixel);
+	return glm::pow(sum / (float)pixels.size(), glm::vec3(2.2f));
+}
+
+// 读回立方体贴图第 0 级（烘焙只需要低频，传入 irradianceMap 即可）
+ProbeSky readProbeSky(unsigned int cubemap)
+{
+	ProbeSky sky;
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+	glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &sky.size);
+	for (int face = 0; face < 6; ++face)
+	{
+		sky.faces[face].resize((size_t)sky.size * sky.size);
+		glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, GL_FLOAT, sky.faces[face].data());
+	}
+	return sky;
+}
+
+// 立方体贴图按 GL 的面选择规则取最近纹素
+static glm::vec3 sampleProbeSky(const ProbeSky& sky, const glm::vec3& direction)
+{
+	if (sky.size == 0) return glm::vec3(0.0f);
+	glm::vec3 a = glm::abs(direction);
+	int face;
+	float sc, tc, ma;
+	if (a.x >= a.y && a.x >= a.z)
+	{
+		face = direction.x > 0.0f ? 0 : 1; ma = a.x;
+		sc = direction.x > 0.0f ? -direction.z : direction.z; tc = -direction.y;
+	}
+	else if (a.y >= a.z)
+	{
+		face = direction.y > 0.0f ? 2 : 3; ma = a.y;
+		sc = direction.x; tc = direction.y > 0.0f ? direction.z : -direction.z;
+	}
+	else
+	{
+		face = direction.z > 0.0f ? 4 : 5; ma = a.z;
+		sc = direction.z > 0.0f ? direction.x : -direction.x; tc = -direction.y;
+	}
+	int x = glm::clamp((int)((sc / ma * 0.5f + 0.5f) * sky.size), 0, sky.size - 1);
+	int y = glm::clamp((int)((tc / ma * 0.5f + 0.5f) * sky.size), 0, sky.size - 1);
+	return glm::min(sky.faces[face][(size_t)y * sky.size + x], glm::vec3(LIGHT_PROBE_SKY_MAX));
+}
+
+static int buildProbeBVHNode(ProbeScene& scene, std::vector<glm::vec3>& centroids, int start, int count)
+{
+	int index = (int)scene.nodes.size();
+	scene.nodes.push_back(ProbeBVHNode());
+
+	glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX), centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+	for (int i = start; i < start + count; ++i)
+	{
+		const ProbeTriangle& t = scene.triangles[i];
+		glm::vec3 b = t.v0 + t.e1, c = t.v0 + t.e2;
+		boundsMin = glm::min(boundsMin, glm::min(t.v0, glm::min(b, c)));
+		boundsMax = glm::max(boundsMax, glm::max(t.v0, glm::max(b, c)));
+		centroidMin = glm::min(centroidMin, centroids[i]);
+		centroidMax = glm::max(centroidMax, centroids[i]);
+	}
+	scene.nodes[index].boundsMin = boundsMin;
+	scene.nodes[index].boundsMax = boundsMax;
+
+	glm::vec3 extent = centroidMax - centroidMin;
+	int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	if (count <= 4 || !(extent[axis] > 0.0f))
+	{
+		scene.nodes[index].start = start;
+		scene.nodes[index].count = count;
+		return index;
+	}
+
+	// 按质心中位数二分，三角形和质心数组一起重排
+	int half = count / 2;
+	std::vector<int> order(count);
+	for (int i = 0; i < count; ++i) order[i] = start + i;
+	std::nth_element(order.begin(), order.begin() + half, order.end(),
+		[&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+	std::vector<ProbeTriangle> triangles(count);
+	std::vector<glm::vec3> sortedCentroids(count);
+	for (int i = 0; i < count; ++i)
+	{
+		triangles[i] = scene.triangles[order[i]];
+		sortedCentroids[i] = centroids[order[i]];
+	}
+	std::copy(triangles.begin(), triangles.end(), scene.triangles.begin() + start);
+	std::copy(sortedCentroids.begin(), sortedCentroids.end(), centroids.begin() + start);
+
+	buildProbeBVHNode(scene, centroids, start, half);
+	int right = buildProbeBVHNode(scene, centroids, start + half, count - half);
+	scene.nodes[index].right = right;
+	return index;
+}
+
+void buildProbeBVH(ProbeScene& scene)
+{
+	scene.nodes.clear();
+	if (scene.triangles.empty()) return;
+	std::vector<glm::vec3> centroids(scene.triangles.size());
+	for (size_t i = 0; i < scene.triangles.size(); ++i)
+	{
+		const ProbeTriangle& t = scene.triangles[i];
+		centroids[i] = t.v0 + (t.e1 + t.e2) / 3.0f;
+	}
+	buildProbeBVHNode(scene, centroids, 0, (int)scene.triangles.size());
+}
+
+static bool probeRayBox(const glm::vec3& origin, const glm::vec3& invDirection, const glm::vec3& boxMin, const glm::vec3& boxMax, float tMax)
+{
+	glm::vec3 t0 = (boxMin - origin) * invDirection;
+	glm::vec3 t1 = (boxMax - origin) * invDirection;
+	glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+	return enter <= exit;
+}
+
+// 双面求交（Möller-Trumbore），anyHit 为真时找到任意交点即返回（阴影光线）
+static bool traceProbeRay(const ProbeScene& scene, const glm::vec3& origin, const glm::vec3& direction, float tMax, bool anyHit, float& hitT, int& hitTriangle)
+{
+	if (scene.nodes.empty()) return false;
+	glm::vec3 invDirection = 1.0f / direction;
+	hitT = tMax;
+	hitTriangle = -1;
+	int stack[64];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		int nodeIndex = stack[--top];
+		const ProbeBVHNode& node = scene.nodes[nodeIndex];
+		if (!probeRayBox(origin, invDirection, node.boundsMin, node.boundsMax, hitT)) continue;
+		if (node.count == 0)
+		{
+			stack[top++] = node.right;
+			stack[top++] = nodeIndex + 1;
+			continue;
+		}
+		for (int i = node.start; i < node.start + node.count; ++i)
+		{
+			const ProbeTriangle& t = scene.triangles[i];
+			glm::vec3 p = glm::cross(direction, t.e2);
+			float det = glm::dot(t.e1, p);
+			if (std::abs(det) < 1e-10f) continue;
+			float invDet = 1.0f / det;
+			glm::vec3 s = origin - t.v0;
+			float u = glm::dot(s, p) * invDet;
+			if (u < 0.0f || u > 1.0f) continue;
+			glm::vec3 q = glm::cross(s, t.e1);
+			float v = glm::dot(direction, q) * invDet;
+			if (v < 0.0f || u + v > 1.0f) continue;
+			float distance = glm::dot(t.e2, q) * invDet;
+			if (distance > 1e-4f && distance < hitT)
+			{
+				hitT = distance;
+				hitTriangle = i;
+				if (anyHit) return true;
+			}
+		}
+	}
+	return hitTriangle >= 0;
+}
+
+// L2 实球谐基函数
+static void shBasis(const glm::vec3& d, float basis[LIGHT_PROBE_SH_COUNT])
+{
+	basis[0] = 0.282095f;
+	basis[1] = 0.488603f * d.y;
+	basis[2] = 0.488603f * d.z;
+	basis[3] = 0.488603f * d.x;
+	basis[4] = 1.092548f * d.x * d.y;
+	basis[5] = 1.092548f * d.y * d.z;
+	basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+	basis[7] = 1.092548f * d.x * d.z;
+	basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+}
+
+static int probeIndex(const LightProbeGrid& grid, int x, int y, int z)
+{
+	return (z * grid.counts.y + y) * grid.counts.x + x;
+}
+
+static glm::vec3 probePosition(const LightProbeGrid& grid, int x, int y, int z)
+{
+	return grid.boundsMin + (grid.boundsMax - grid.boundsMin) * glm::vec3(x, y, z) / glm::vec3(grid.counts - 1);
+}
+
+// CPU 上的探针求值，与 pbr_lighting.glsl 的 sampleLightProbes 相同（第二次反弹用）
+static glm::vec3 evaluateLightProbes(const LightProbeGrid& grid, const glm::vec3& position, const glm::vec3& normal)
+{
+	glm::vec3 cell = (position + normal * LIGHT_PROBE_NORMAL_BIAS - grid.boundsMin) / (grid.boundsMax - grid.boundsMin) * glm::vec3(grid.counts - 1);
+	cell = glm::clamp(cell, glm::vec3(0.0f), glm::vec3(grid.counts - 1));
+	glm::ivec3 base = glm::min(glm::ivec3(cell), grid.counts - 2);
+	glm::vec3 f = cell - glm::vec3(base);
+	float basis[LIGHT_PROBE_SH_COUNT];
+	shBasis(normal, basis);
+
+	glm::vec3 result(0.0f);
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		glm::ivec3 offset((corner & 1), (corner >> 1) & 1, (corner >> 2) & 1);
+		float weight = (offset.x ? f.x : 1.0f - f.x) * (offset.y ? f.y : 1.0f - f.y) * (offset.z ? f.z : 1.0f - f.z);
+		const glm::vec3* sh = &grid.coefficients[(size_t)probeIndex(grid, base.x + offset.x, base.y + offset.y, base.z + offset.z) * LIGHT_PROBE_SH_COUNT];
+		for (int i = 0; i < LIGHT_PROBE_SH_COUNT; ++i)
+			result += sh[i] * basis[i] * weight;
+	}
+	return glm::max(result, glm::vec3(0.0f));
+}
+
+// 命中表面的直接光：所有点光源（与 light_clusters.glsl 相同的衰减和聚光锥），阴影光线判断可见性
+// shadowRays 非空时累加发出的阴影光线数（光照贴图烘焙统计吞吐量）
+static glm::vec3 probeDirectIrradiance(const ProbeScene& scene, const std::vector<ProbeLight>& lights, const glm::vec3& position, const glm::vec3& normal, size_t* shadowRays = nullptr)
+{
+	glm::vec3 irradiance(0.0f);
+	glm::vec3 origin = position + normal * 1e-3f;
+	for (const ProbeLight& light : lights)
+	{
+		glm::vec3 toLight = light.position - position;
+		float distance = glm::length(toLight);
+		if (distance >= light.range || distance < 1e-4f) continue;
+		glm::vec3 L = toLight / distance;
+		float NdotL = glm::dot(normal, L);
+		if (NdotL <= 0.0f) continue;
+
+		float ratio = distance / light.range;
+		float window = glm::clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+		float attenuation = window * window / (distance * distance);
+		float spot = 1.0f;
+		if (light.cutOff > 0.0f)
+			spot = glm::smoothstep(light.cutOff, light.cutOff + (1.0f - light.cutOff) * 0.15f, glm::dot(-L, light.direction));
+		if (spot <= 0.0f) continue;
+
+		float t;
+		int triangle;
+		if (shadowRays) (*shadowRays)++;
+		if (traceProbeRay(scene, origin, L, distance - 0.05f, true, t, triangle)) continue;
+		irradiance += light.color * attenuation * spot * NdotL;
+	}
+	return irradiance;
+}
+
+// 每条光线的缓存：第一次反弹算好直接光，之后的反弹只需要加上一轮的探针求值
+struct ProbeRayHit
+{
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec3 albedo;
+	glm::vec3 radiance; // 直接光的出射辐亮度或天空辐亮度
+	bool surface;
+};
+
+void bakeLightProbes(LightProbeGrid& grid, const ProbeScene& scene, const std::vector<ProbeLight>& lights, const ProbeSky& sky)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	int probeCount = grid.counts.x * grid.counts.y * grid.counts.z;
+
+	// 球面 Fibonacci 点作为所有探针共用的光线方向，预先算好球谐基
+	std::vector<glm::vec3> directions(LIGHT_PROBE_RAYS);
+	std::vector<float> basis((size_t)LIGHT_PROBE_RAYS * LIGHT_PROBE_SH_COUNT);
+	for (int r = 0; r < LIGHT_PROBE_RAYS; ++r)
+	{
+		float z = 1.0f - (2.0f * r + 1.0f) / LIGHT_PROBE_RAYS;
+		float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+		float phi = r * 2.39996323f; // 黄金角
+		directions[r] = glm::vec3(radius * std::cos(phi), radius * std::sin(phi), z);
+		shBasis(directions[r], &basis[(size_t)r * LIGHT_PROBE_SH_COUNT]);
+	}
+
+	std::vector<ProbeRayHit> hits((size_t)probeCount * LIGHT_PROBE_RAYS);
+	std::vector<char> buried(probeCount, 0);
+	std::vector<glm::vec3> coefficients(grid.coefficients.size(), glm::vec3(0.0f));
+	// 余弦卷积 A_l（π, 2π/3, π/4）除以 π，再乘蒙特卡洛权重 4π / N
+	const float convolution[LIGHT_PROBE_SH_COUNT] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+	const float weight = 4.0f * glm::pi<float>() / LIGHT_PROBE_RAYS;
+
+	unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+	for (int bounce = 0; bounce < LIGHT_PROBE_BOUNCES; ++bounce)
+	{
+		std::atomic<int> nextProbe(0);
+		auto worker = [&]() {
+			for (int p = nextProbe++; p < probeCount; p = nextProbe++)
+			{
+				int x = p % grid.counts.x, y = (p / grid.counts.x) % grid.counts.y, z = p / (grid.counts.x * grid.counts.y);
+				glm::vec3 origin = probePosition(grid, x, y, z);
+				glm::vec3 sh[LIGHT_PROBE_SH_COUNT] = {};
+				int backfaces = 0;
+				for (int r = 0; r < LIGHT_PROBE_RAYS; ++r)
+				{
+					ProbeRayHit& hit = hits[(size_t)p * LIGHT_PROBE_RAYS + r];
+					if (bounce == 0)
+					{
+						float t;
+						int triangle;
+						hit.surface = traceProbeRay(scene, origin, directions[r], FLT_MAX, false, t, triangle);
+						if (hit.surface)
+						{
+							const ProbeTriangle& tri = scene.triangles[triangle];
+							bool backface = glm::dot(tri.normal, directions[r]) > 0.0f;
+							backfaces += backface ? 1 : 0;
+							hit.position = origin + directions[r] * t;
+							hit.normal = backface ? -tri.normal : tri.normal;
+							// 背面（几何体内部）不反射光
+							hit.albedo = backface ? glm::vec3(0.0f) : tri.albedo;
+							hit.radiance = backface ? glm::vec3(0.0f)
+								: tri.albedo / glm::pi<float>() * probeDirectIrradiance(scene, lights, hit.position, hit.normal);
+						}
+						else
+						{
+							hit.radiance = sampleProbeSky(sky, directions[r]);
+						}
+					}
+
+					glm::vec3 radiance = hit.radiance;
+					if (bounce > 0 && hit.surface)
+						radiance += hit.albedo * evaluateLightProbes(grid, hit.position, hit.normal);
+					for (int i = 0; i < LIGHT_PROBE_SH_COUNT; ++i)
+						sh[i] += radiance * basis[(size_t)r * LIGHT_PROBE_SH_COUNT + i];
+				}
+				for (int i = 0; i < LIGHT_PROBE_SH_COUNT; ++i)
+					coefficients[(size_t)p * LIGHT_PROBE_SH_COUNT + i] = sh[i] * weight * convolution[i];
+				if (bounce == 0) buried[p] = backfaces > LIGHT_PROBE_BURIED_RATIO * LIGHT_PROBE_RAYS;
+			}
+		};
+		std::vector<std::thread> threads;
+		for (unsigned int i = 0; i < threadCount; ++i) threads.emplace_back(worker);
+		for (std::thread& thread : threads) thread.join();
+
+		// 埋在几何体里的探针看到的全是背面，逐轮用有效的相邻探针平均值填充
+		std::vector<char> valid(probeCount);
+		for (int p = 0; p < probeCount; ++p) valid[p] = !buried[p];
+		for (bool changed = true; changed;)
+		{
+			changed = false;
+			std::vector<char> filled = valid;
+			for (int p = 0; p < probeCount; ++p)
+			{
+				if (valid[p]) continue;
+				int x = p % grid.counts.x, y = (p / grid.counts.x) % grid.counts.y, z = p / (grid.counts.x * grid.counts.y);
+				const glm::ivec3 neighbors[6] = { { x - 1, y, z }, { x + 1, y, z }, { x, y - 1, z }, { x, y + 1, z }, { x, y, z - 1 }, { x, y, z + 1 } };
+				glm::vec3 sum[LIGHT_PROBE_SH_COUNT] = {};
+				int count = 0;
+				for (const glm::ivec3& n : neighbors)
+				{
+					if (glm::any(glm::lessThan(n, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(n, grid.counts))) continue;
+					int q = probeIndex(grid, n.x, n.y, n.z);
+					if (!valid[q]) continue;
+					for (int i = 0; i < LIGHT_PROBE_SH_COUNT; ++i) sum[i] += coefficients[(size_t)q * LIGHT_PROBE_SH_COUNT + i];
+					count++;
+				}
+				if (count == 0) continue;
+				for (int i = 0; i < LIGHT_PROBE_SH_COUNT; ++i) coefficients[(size_t)p * LIGHT_PROBE_SH_COUNT + i] = sum[i] / (float)count;
+				filled[p] = 1;
+				changed = true;
+			}
+			valid.swap(filled);
+		}
+		grid.coefficients = coefficients;
+	}
+
+	int buriedCount = (int)std::count(buried.begin(), buried.end(), 1);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "[LightProbes] baked " << grid.counts.x << "x" << grid.counts.y << "x" << grid.counts.z << " probes ("
+		<< buriedCount << " buried), " << scene.triangles.size() << " triangles, " << threadCount << " threads, "
+		<< seconds << " s" << std::endl;
+}
+
+// FNV-1a：三角形、灯光和网格参数任一变化都会使缓存失效
+static void hashBytes(uint32_t& hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+}
+
+uint32_t lightProbeSceneHash(const LightProbeGrid& grid, const ProbeScene& scene, const std::vector<ProbeLight>& lights)
+{
+	uint32_t hash = 2166136261u;
+	for (const ProbeTriangle& t : scene.triangles)
+	{
+		hashBytes(hash, &t.v0, sizeof(glm::vec3) * 3);
+		hashBytes(hash, &t.albedo, sizeof(glm::vec3));
+	}
+	for (const ProbeLight& light : lights) hashBytes(hash, &light, sizeof(ProbeLight));
+	const int settings[3] = { LIGHT_PROBE_RAYS, LIGHT_PROBE_BOUNCES, (int)(LIGHT_PROBE_SKY_MAX * 1000.0f) };
+	hashBytes(hash, settings, sizeof(settings));
+	hashBytes(hash, &grid.boundsMin, sizeof(glm::vec3));
+	hashBytes(hash, &grid.boundsMax, sizeof(glm::vec3));
+	return hash;
+}
+
+// 文件格式：头部 (magic, version, hash, nx, ny, nz) + 包围盒 6 个 float + 每个探针 27 个半精度系数
+bool loadLightProbes(LightProbeGrid& grid, const char* path, uint32_t hash)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+	uint32_t header[6] = {};
+	float bounds[6] = {};
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	file.read(reinterpret_cast<char*>(bounds), sizeof(bounds));
+	if (!file || header[0] != LIGHT_PROBE_MAGIC || header[1] != LIGHT_PROBE_VERSION || header[2] != hash) return false;
+	if ((int)header[3] != grid.counts.x || (int)header[4] != grid.counts.y || (int)header[5] != grid.counts.z) return false;
+
+	std::vector<uint16_t> packed(grid.coefficients.size() * 3);
+	file.read(reinterpret_cast<char*>(packed.data()), packed.size() * sizeof(uint16_t));
+	if (!file) return false;
+	for (size_t i = 0; i < grid.coefficients.size(); ++i)
+	{
+		grid.coefficients[i] = glm::vec3(glm::unpackHalf1x16(packed[i * 3]), glm::unpackHalf1x16(packed[i * 3 + 1]), glm::unpackHalf1x16(packed[i * 3 + 2]));
+	}
+	return true;
+}
+
+void saveLightProbes(const LightProbeGrid& grid, const char* path, uint32_t hash)
+{
+	uint32_t header[6] = { LIGHT_PROBE_MAGIC, LIGHT_PROBE_VERSION, hash, (uint32_t)grid.counts.x, (uint32_t)grid.counts.y, (uint32_t)grid.counts.z };
+	float bounds[6] = { grid.boundsMin.x, grid.boundsMin.y, grid.boundsMin.z, grid.boundsMax.x, grid.boundsMax.y, grid.boundsMax.z };
+	std::vector<uint16_t> packed(grid.coefficients.size() * 3);
+	for (size_t i = 0; i < grid.coefficients.size(); ++i)
+	{
+		for (int c = 0; c < 3; ++c) packed[i * 3 + c] = glm::packHalf1x16(grid.coefficients[i][c]);
+	}
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+	file.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(uint16_t));
+	if (!file) std::cout << "Failed to write light probe cache: " << path << std::endl;
+}
+
+// 上传为二维纹理：x 方向按系数分 9 段，y 方向按层分 nz 段；着色器把坐标限制在纹素中心之间，线性过滤不会跨段，层间自己插值
+void uploadLightProbes(LightProbeGrid& grid)
+{
+	int maxUnits = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+	if (maxUnits <= LIGHT_PROBE_TEXTURE_UNIT)
+	{
+		std::cout << "[LightProbes] only " << maxUnits << " texture units, light probes disabled" << std::endl;
+		grid.enabled = false;
+		return;
+	}
+
+	int width = grid.counts.x * LIGHT_PROBE_SH_COUNT;
+	int height = grid.counts.y * grid.counts.z;
+	std::vector<glm::vec3> texels((size_t)width * height);
+	for (int z = 0; z < grid.counts.z; ++z)
+		for (int y = 0; y < grid.counts.y; ++y)
+			for (int x = 0; x < grid.counts.x; ++x)
+				for (int i = 0; i < LIGHT_PROBE_SH_COUNT; ++i)
+					texels[((size_t)z * grid.counts.y + y) * width + i * grid.counts.x + x] =
+						grid.coefficients[(size_t)probeIndex(grid, x, y, z) * LIGHT_PROBE_SH_COUNT + i];
+
+	if (grid.texture == 0) glGenTextures(1, &grid.texture);
+	glBindTexture(GL_TEXTURE_2D, grid.texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void setLightProbeUniforms(Shader& shader)
+{
+	shader.setBool("useLightProbes", lightProbeGrid.enabled && lightProbeGrid.texture != 0);
+	shader.setInt("lightProbes", lightProbeGrid.texture != 0 ? LIGHT_PROBE_TEXTURE_UNIT : LIGHT_PROBE_FALLBACK_UNIT);
+	shader.setVec3("lightProbeMin", lightProbeGrid.boundsMin);
+	shader.setVec3("lightProbeMax", lightProbeGrid.boundsMax);
+	glUniform3i(glGetUniformLocation(shader.ID, "lightProbeCount"), lightProbeGrid.counts.x, lightProbeGrid.counts.y, lightProbeGrid.counts.z);
+}
+
+void bindLightProbes()
+{
+	if (lightProbeGrid.texture == 0) return;
+	glActiveTexture(GL_TEXTURE0 + LIGHT_PROBE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, lightProbeGrid.texture);
+}
+#endif
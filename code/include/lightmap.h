@@ -0,0 +1,349 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <shader.h>
+#include "light_probes.h"
+
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cfloat>
+#include <cmath>
+
+// 静态图块（地板/墙/天花板）的光照贴图：每个图块的上下两个大面各占图集里一块 LIGHTMAP_CHART_SIZE 见方的图表，
+// 面内 uv 就是网格自带的 0~1 纹理坐标，边缘正好落在边缘纹素中心，双线性过滤不会读到相邻图表
+// 离线在 CPU 上多线程烘焙（与探针共用场景 BVH）：点光源直接光带阴影光线，间接光按余弦分布发射 4 条一组的光线包，
+// 命中点再算一次直接光并用探针网格近似更多次反弹，未命中取天空；结果以 RGB9_E5 共享指数格式缓存和上传，与探针一起由 --bake 烘焙
+// 运行时带光照贴图的面不再走分簇点光源循环（点光源的高光一并烘焙成漫反射），平行光仍然实时计算
+const uint32_t LIGHTMAP_MAGIC = 0x50414D4C; // "LMAP"
+const uint32_t LIGHTMAP_VERSION = 1;
+const int LIGHTMAP_CHART_SIZE = 32; // 与 pbr.vs 一致
+const int LIGHTMAP_SAMPLES = 32;    // 每个纹素的间接光线数，4 的倍数
+const int LIGHTMAP_PACKET = 4;
+const int LIGHTMAP_TEXTURE_UNIT = 17;
+const int LIGHTMAP_FALLBACK_UNIT = 2; // 单元不够或没有烘焙结果时不创建纹理，采样器改指同为 sampler2D 的 brdfLUT 单元，避免类型冲突
+const float LIGHTMAP_TILE_THICKNESS = 0.2f; // 图块厚度，与 SceneRender.h 的 TILE_BOUNDS_MIN.y 一致
+
+// 图块网格两个大面的局部参数，与 SceneRender.h 中 renderGround/renderWall 的 addFace 一致
+struct LightmapFace
+{
+	glm::vec3 center, axisX, axisY, normal;
+};
+const LightmapFace LIGHTMAP_FACES[2] = {
+	{ glm::vec3(0.0f), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0) },
+	{ glm::vec3(0.0f, -LIGHTMAP_TILE_THICKNESS, 0.0f), glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, -1, 0) },
+};
+
+struct LightmapChart
+{
+	glm::mat4 model;
+	int face; // 0: 上表面, 1: 下表面
+};
+
+struct Lightmap
+{
+	int chartCount = 0;
+	int columns = 0;
+	int width = 0;
+	int height = 0;
+	// 每组实例化绘制的第一个图表：实例 k 的上表面为 base + 2k，下表面为 base + 2k + 1
+	int floorBase = -1;
+	int wallBase = -1;
+	int ceilingBase = -1;
+	std::vector<uint32_t> texels; // RGB9_E5
+	unsigned int texture = 0;
+	bool enabled = true;
+};
+Lightmap lightmap;
+
+void initLightmapLayout(Lightmap& map, int floorCount, int wallCount, int ceilingCount);
+void addLightmapCharts(std::vector<LightmapChart>& charts, const std::vector<glm::mat4>& modelMatrices);
+void bakeLightmap(Lightmap& map, const std::vector<LightmapChart>& charts, const ProbeScene& scene, const std::vector<ProbeLight>& lights,
+	const ProbeSky& sky, const LightProbeGrid& probes, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+uint32_t lightmapHash(const Lightmap& map, uint32_t sceneHash);
+bool loadLightmap(Lightmap& map, const char* path, uint32_t hash);
+void saveLightmap(const Lightmap& map, const char* path, uint32_t hash);
+void uploadLightmap(Lightmap& map);
+void setLightmapUniforms(Shader& shader);
+void bindLightmap();
+
+// 图表按地板、墙、天花板的实例顺序排进接近正方形的图集
+void initLightmapLayout(Lightmap& map, int floorCount, int wallCount, int ceilingCount)
+{
+	map.floorBase = 0;
+	map.wallBase = map.floorBase + floorCount * 2;
+	map.ceilingBase = map.wallBase + wallCount * 2;
+	map.chartCount = map.ceilingBase + ceilingCount * 2;
+	map.columns = std::max(1, (int)std::ceil(std::sqrt((float)map.chartCount)));
+	int rows = std::max(1, (map.chartCount + map.columns - 1) / map.columns);
+	map.width = map.columns * LIGHTMAP_CHART_SIZE;
+	map.height = rows * LIGHTMAP_CHART_SIZE;
+	map.texels.assign((size_t)map.width * map.height, 0u);
+}
+
+void addLightmapCharts(std::vector<LightmapChart>& charts, const std::vector<glm::mat4>& modelMatrices)
+{
+	for (const glm::mat4& model : modelMatrices)
+	{
+		charts.push_back({ model, 0 });
+		charts.push_back({ model, 1 });
+	}
+}
+
+// 4 条光线的包，按分量分开存放（SoA），逐通道的循环由编译器向量化
+struct LightmapRayPacket
+{
+	float ox[LIGHTMAP_PACKET], oy[LIGHTMAP_PACKET], oz[LIGHTMAP_PACKET];
+	float dx[LIGHTMAP_PACKET], dy[LIGHTMAP_PACKET], dz[LIGHTMAP_PACKET];
+	float ix[LIGHTMAP_PACKET], iy[LIGHTMAP_PACKET], iz[LIGHTMAP_PACKET]; // 方向倒数
+	float t[LIGHTMAP_PACKET];
+	int triangle[LIGHTMAP_PACKET];
+};
+
+// 光线包一起遍历 BVH：任一光线与节点相交就进入，三角形对 4 条光线同时求交
+static void traceLightmapPacket(const ProbeScene& scene, LightmapRayPacket& packet)
+{
+	for (int k = 0; k < LIGHTMAP_PACKET; ++k)
+	{
+		packet.ix[k] = 1.0f / packet.dx[k];
+		packet.iy[k] = 1.0f / packet.dy[k];
+		packet.iz[k] = 1.0f / packet.dz[k];
+		packet.t[k] = FLT_MAX;
+		packet.triangle[k] = -1;
+	}
+	if (scene.nodes.empty()) return;
+
+	int stack[64];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		int nodeIndex = stack[--top];
+		const ProbeBVHNode& node = scene.nodes[nodeIndex];
+		bool hitAny = false;
+		for (int k = 0; k < LIGHTMAP_PACKET; ++k)
+		{
+			float tx0 = (node.boundsMin.x - packet.ox[k]) * packet.ix[k], tx1 = (node.boundsMax.x - packet.ox[k]) * packet.ix[k];
+			float ty0 = (node.boundsMin.y - packet.oy[k]) * packet.iy[k], ty1 = (node.boundsMax.y - packet.oy[k]) * packet.iy[k];
+			float tz0 = (node.boundsMin.z - packet.oz[k]) * packet.iz[k], tz1 = (node.boundsMax.z - packet.oz[k]) * packet.iz[k];
+			float enter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+			float exit = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), packet.t[k]));
+			hitAny |= enter <= exit;
+		}
+		if (!hitAny) continue;
+		if (node.count == 0)
+		{
+			stack[top++] = node.right;
+			stack[top++] = nodeIndex + 1;
+			continue;
+		}
+
+		for (int i = node.start; i < node.start + node.count; ++i)
+		{
+			const ProbeTriangle& tri = scene.triangles[i];
+			for (int k = 0; k < LIGHTMAP_PACKET; ++k)
+			{
+				// Möller-Trumbore，与 traceProbeRay 相同
+				float px = packet.dy[k] * tri.e2.z - packet.dz[k] * tri.e2.y;
+				float py = packet.dz[k] * tri.e2.x - packet.dx[k] * tri.e2.z;
+				float pz = packet.dx[k] * tri.e2.y - packet.dy[k] * tri.e2.x;
+				float det = tri.e1.x * px + tri.e1.y * py + tri.e1.z * pz;
+				float invDet = 1.0f / det;
+				float sx = packet.ox[k] - tri.v0.x, sy = packet.oy[k] - tri.v0.y, sz = packet.oz[k] - tri.v0.z;
+				float u = (sx * px + sy * py + sz * pz) * invDet;
+				float qx = sy * tri.e1.z - sz * tri.e1.y;
+				float qy = sz * tri.e1.x - sx * tri.e1.z;
+				float qz = sx * tri.e1.y - sy * tri.e1.x;
+				float v = (packet.dx[k] * qx + packet.dy[k] * qy + packet.dz[k] * qz) * invDet;
+				float distance = (tri.e2.x * qx + tri.e2.y * qy + tri.e2.z * qz) * invDet;
+				bool hit = std::abs(det) >= 1e-10f && u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f
+					&& distance > 1e-4f && distance < packet.t[k];
+				packet.t[k] = hit ? distance : packet.t[k];
+				packet.triangle[k] = hit ? i : packet.triangle[k];
+			}
+		}
+	}
+}
+
+static uint32_t lightmapRandom(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+void bakeLightmap(Lightmap& map, const std::vector<LightmapChart>& charts, const ProbeScene& scene, const std::vector<ProbeLight>& lights,
+	const ProbeSky& sky, const LightProbeGrid& probes, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	const float invPi = 1.0f / glm::pi<float>();
+	const bool useProbes = !probes.coefficients.empty();
+	std::atomic<int> nextChart(0);
+	std::atomic<size_t> totalRays(0);
+	std::atomic<int> bakedCharts(0);
+
+	auto worker = [&]() {
+		size_t rays = 0;
+		for (int c = nextChart++; c < (int)charts.size() && c < map.chartCount; c = nextChart++)
+		{
+			const LightmapChart& chart = charts[c];
+			const LightmapFace& face = LIGHTMAP_FACES[chart.face];
+			glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(chart.model)));
+			glm::vec3 n = glm::normalize(normalMatrix * face.normal);
+			glm::vec3 tangent = glm::normalize(glm::mat3(chart.model) * face.axisX);
+			tangent = glm::normalize(tangent - glm::dot(tangent, n) * n);
+			glm::vec3 bitangent = glm::cross(n, tangent);
+
+			// 朝向图书馆外部的面（墙外侧、地板底面、天花板顶面）看不到，不烘焙
+			glm::vec3 probe = glm::vec3(chart.model * glm::vec4(face.center, 1.0f)) + n * 0.5f;
+			if (glm::any(glm::lessThan(probe, boundsMin - 0.5f)) || glm::any(glm::greaterThan(probe, boundsMax + 0.5f))) continue;
+			bakedCharts++;
+
+			int cellX = (c % map.columns) * LIGHTMAP_CHART_SIZE;
+			int cellY = (c / map.columns) * LIGHTMAP_CHART_SIZE;
+			for (int j = 0; j < LIGHTMAP_CHART_SIZE; ++j)
+			{
+				for (int i = 0; i < LIGHTMAP_CHART_SIZE; ++i)
+				{
+					float u = (float)i / (LIGHTMAP_CHART_SIZE - 1);
+					float v = (float)j / (LIGHTMAP_CHART_SIZE - 1);
+					glm::vec3 local = face.center + (u - 0.5f) * face.axisX + (v - 0.5f) * face.axisY;
+					glm::vec3 position = glm::vec3(chart.model * glm::vec4(local, 1.0f));
+					glm::vec3 origin = position + n * 1e-3f;
+
+					// 直接光：结果约定为 E / π
+					glm::vec3 irradiance = probeDirectIrradiance(scene, lights, position, n, &rays) * invPi;
+
+					// 间接光：余弦分布分层采样，此时 E / π 就是辐亮度的平均值
+					uint32_t seed = (uint32_t)(c * 9781 + j * 6271 + i * 26699) | 1u;
+					glm::vec3 indirect(0.0f);
+					for (int s = 0; s < LIGHTMAP_SAMPLES; s += LIGHTMAP_PACKET)
+					{
+						LightmapRayPacket packet;
+						glm::vec3 directions[LIGHTMAP_PACKET];
+						for (int k = 0; k < LIGHTMAP_PACKET; ++k)
+						{
+							float r1 = ((float)(s + k) + (lightmapRandom(seed) & 0xFFFF) / 65536.0f) / LIGHTMAP_SAMPLES;
+							float phi = 2.0f * glm::pi<float>() * (lightmapRandom(seed) & 0xFFFF) / 65536.0f;
+							float radius = std::sqrt(r1);
+							directions[k] = tangent * (radius * std::cos(phi)) + bitangent * (radius * std::sin(phi)) + n * std::sqrt(std::max(0.0f, 1.0f - r1));
+							packet.ox[k] = origin.x; packet.oy[k] = origin.y; packet.oz[k] = origin.z;
+							packet.dx[k] = directions[k].x; packet.dy[k] = directions[k].y; packet.dz[k] = directions[k].z;
+						}
+						traceLightmapPacket(scene, packet);
+						rays += LIGHTMAP_PACKET;
+
+						for (int k = 0; k < LIGHTMAP_PACKET; ++k)
+						{
+							if (packet.triangle[k] < 0)
+							{
+								indirect += sampleProbeSky(sky, directions[k]);
+								continue;
+							}
+							const ProbeTriangle& tri = scene.triangles[packet.triangle[k]];
+							if (glm::dot(tri.normal, directions[k]) > 0.0f) continue; // 背面：几何体内部
+							glm::vec3 hitPosition = origin + directions[k] * packet.t[k];
+							glm::vec3 radiance = tri.albedo * invPi * probeDirectIrradiance(scene, lights, hitPosition, tri.normal, &rays);
+							if (useProbes) radiance += tri.albedo * evaluateLightProbes(probes, hitPosition, tri.normal);
+							indirect += radiance;
+						}
+					}
+					irradiance += indirect / (float)LIGHTMAP_SAMPLES;
+					map.texels[(size_t)(cellY + j) * map.width + cellX + i] = glm::packF3x9_E1x5(irradiance);
+				}
+			}
+		}
+		totalRays += rays;
+	};
+
+	unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < threadCount; ++i) threads.emplace_back(worker);
+	for (std::thread& thread : threads) thread.join();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	double raysPerCore = totalRays / std::max(seconds, 1e-6) / threadCount;
+	std::cout << "[Lightmap] baked " << bakedCharts << "/" << map.chartCount << " charts into " << map.width << "x" << map.height
+		<< ", " << totalRays << " rays in " << seconds << " s, " << raysPerCore / 1e6 << " Mrays/s per core (" << threadCount << " threads)" << std::endl;
+}
+
+// 光照贴图依赖场景（与探针相同的哈希）、图表布局和采样设置
+uint32_t lightmapHash(const Lightmap& map, uint32_t sceneHash)
+{
+	uint32_t hash = sceneHash;
+	const int settings[5] = { map.chartCount, map.columns, LIGHTMAP_CHART_SIZE, LIGHTMAP_SAMPLES, (int)LIGHTMAP_VERSION };
+	hashBytes(hash, settings, sizeof(settings));
+	return hash;
+}
+
+// 文件格式：头部 (magic, version, hash, width, height) + 每纹素一个 RGB9_E5
+bool loadLightmap(Lightmap& map, const char* path, uint32_t hash)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+	uint32_t header[5] = {};
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!file || header[0] != LIGHTMAP_MAGIC || header[1] != LIGHTMAP_VERSION || header[2] != hash) return false;
+	if ((int)header[3] != map.width || (int)header[4] != map.height) return false;
+	file.read(reinterpret_cast<char*>(map.texels.data()), map.texels.size() * sizeof(uint32_t));
+	return (bool)file;
+}
+
+void saveLightmap(const Lightmap& map, const char* path, uint32_t hash)
+{
+	uint32_t header[5] = { LIGHTMAP_MAGIC, LIGHTMAP_VERSION, hash, (uint32_t)map.width, (uint32_t)map.height };
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(map.texels.data()), map.texels.size() * sizeof(uint32_t));
+	if (!file) std::cout << "Failed to write lightmap cache: " << path << std::endl;
+}
+
+void uploadLightmap(Lightmap& map)
+{
+	int maxUnits = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+	if (maxUnits <= LIGHTMAP_TEXTURE_UNIT)
+	{
+		std::cout << "[Lightmap] only " << maxUnits << " texture units, lightmap disabled" << std::endl;
+		map.enabled = false;
+		return;
+	}
+
+	if (map.texture == 0) glGenTextures(1, &map.texture);
+	glBindTexture(GL_TEXTURE_2D, map.texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB9_E5, map.width, map.height, 0, GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, map.texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// 不透明通道开始时调用；各组图块绘制前再单独设置 lightmapBase
+void setLightmapUniforms(Shader& shader)
+{
+	shader.setBool("useLightmap", lightmap.enabled && lightmap.texture != 0);
+	shader.setInt("lightmap", lightmap.texture != 0 ? LIGHTMAP_TEXTURE_UNIT : LIGHTMAP_FALLBACK_UNIT);
+	shader.setInt("lightmapBase", -1);
+	shader.setInt("lightmapColumns", std::max(lightmap.columns, 1));
+	shader.setVec2("lightmapSize", (float)lightmap.width, (float)lightmap.height);
+}
+
+void bindLightmap()
+{
+	if (lightmap.texture == 0) return;
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, lightmap.texture);
+}
+#endif
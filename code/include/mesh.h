@@ -10,6 +10,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <cfloat>
 using namespace std;
 
 #define MAX_BONE_INFLUENCE 4
@@ -44,6 +46,8 @@ public:
 	vector<unsigned int> indices;
 	vector<Texture>      textures;
 	unsigned int VAO;
+	unsigned int positionVAO; // 只含位置、按位置去重的顶点流，供深度预通道和阴影使用
+	unsigned int positionVertexCount = 0; // 去重后的顶点数
 
 	glm::vec4 baseColorFactor;
 	glm::vec3 emissiveFactor;
@@ -55,6 +59,10 @@ public:
 	bool doubleSided = false;
 	bool isblend = false;
 
+	// 模型空间包围盒，用于剔除和透明排序
+	glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+	glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+
 	// constructor
 	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures,
 		glm::vec4 baseColor = glm::vec4(1.0f), float metallic = 1.0f, float roughness = 1.0f, 
@@ -75,11 +83,21 @@ public:
 		this->doubleSided = doubleSide;
 		this->isblend = isblend;
 
+		for (const Vertex& vertex : this->vertices)
+		{
+			boundsMin = glm::min(boundsMin, vertex.Position);
+			boundsMax = glm::max(boundsMax, vertex.Position);
+		}
+
 		// now that we have all the required data, set the vertex buffers and its attribute pointers.
 		setupMesh();
 	}
 
+	// 玻璃和混合材质走透明通道
+	bool isTransparent() const { return isGlass || isblend; }
+
 	// render the mesh
+	// 混合/深度写入/面剔除状态由调用方按通道统一设置，这里只绑定材质并绘制
 	void Draw(Shader& shader, bool depth = false)
 	{
 		if (depth)
@@ -91,20 +109,6 @@ public:
 			return;
 		}
 
-		GLboolean oldBlend, oldCullFace, oldDepthMask;
-		GLint oldBlendSrc, oldBlendDst;
-		GLint oldDepthFunc;
-		// 保存混合状态
-		glGetBooleanv(GL_BLEND, &oldBlend);
-		glGetIntegerv(GL_BLEND_SRC, &oldBlendSrc);
-		glGetIntegerv(GL_BLEND_DST, &oldBlendDst);
-		// 保存面剔除状态
-		glGetBooleanv(GL_CULL_FACE, &oldCullFace);
-		// 保存深度写入状态
-		glGetBooleanv(GL_DEPTH_WRITEMASK, &oldDepthMask);
-		// 保存深度测试函数（天空盒依赖GL_LEQUAL）
-		glGetIntegerv(GL_DEPTH_FUNC, &oldDepthFunc);
-
 		shader.setBool("useAlbedoMap", false);
 		shader.setBool("useNormalMap", false);
 		shader.setBool("useMetallicRoughnessMap", false);
@@ -215,47 +219,38 @@ public:
 
 		//绘制逻辑
 		glBindVertexArray(VAO);
-		if (isGlass)
-		{
-			// 玻璃材质：开启混合、关闭深度写入、双面渲染
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			glDepthMask(GL_FALSE);
-			if (doubleSided) glDisable(GL_CULL_FACE);
-		}
-		else
-		{
-			if (isblend)
-			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			}
-			if (doubleSided) glDisable(GL_CULL_FACE);
-			// 非玻璃材质：正常绘制  
-		}
-
 		glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
 		glBindVertexArray(0);
 
-		// 恢复所有原始OpenGL状态
-		// 恢复混合状态
-		if (oldBlend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-		glBlendFunc(oldBlendSrc, oldBlendDst);
-		// 恢复面剔除
-		if (oldCullFace) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-		// 恢复深度写入
-		glDepthMask(oldDepthMask);
-		// 恢复深度测试函数
-		glDepthFunc(oldDepthFunc);
 		// 恢复默认纹理单元
 		glActiveTexture(GL_TEXTURE3);
 		// 重置玻璃标记
 		shader.setBool("isGlass", false);
 	}
 
+	// 只绘制位置（深度预通道/阴影），每个顶点只读 12 字节而不是整个 Vertex
+	void DrawPositions()
+	{
+		glBindVertexArray(positionVAO);
+		glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+		glBindVertexArray(0);
+	}
+
 private:
 	// render data 
 	unsigned int VBO, EBO;
+	unsigned int positionVBO, positionEBO;
+
+	// 按位精确比较位置，用于去重
+	struct PositionLess
+	{
+		bool operator()(const glm::vec3& a, const glm::vec3& b) const
+		{
+			if (a.x != b.x) return a.x < b.x;
+			if (a.y != b.y) return a.y < b.y;
+			return a.z < b.z;
+		}
+	};
 
 	// initializes all the buffer objects/arrays
 	void setupMesh()
@@ -299,6 +294,37 @@ private:
 		glEnableVertexAttribArray(6);
 		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
 		glBindVertexArray(0);
+
+		// 紧凑的位置流：法线/UV 接缝处拆开的顶点在只看位置时是同一个点，按位置去重后用自己的索引缓冲
+		vector<glm::vec3> positions;
+		vector<unsigned int> remap(vertices.size());
+		map<glm::vec3, unsigned int, PositionLess> unique;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			auto it = unique.find(vertices[i].Position);
+			if (it == unique.end())
+			{
+				it = unique.insert({ vertices[i].Position, (unsigned int)positions.size() }).first;
+				positions.push_back(vertices[i].Position);
+			}
+			remap[i] = it->second;
+		}
+		positionVertexCount = (unsigned int)positions.size();
+		vector<unsigned int> positionIndices(indices.size());
+		for (size_t i = 0; i < indices.size(); i++)
+			positionIndices[i] = remap[indices[i]];
+
+		glGenVertexArrays(1, &positionVAO);
+		glGenBuffers(1, &positionVBO);
+		glGenBuffers(1, &positionEBO);
+		glBindVertexArray(positionVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+		glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, positionEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, positionIndices.size() * sizeof(unsigned int), &positionIndices[0], GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+		glBindVertexArray(0);
 	}
 };
 #endif
\ No newline at end of file
@@ -21,10 +21,16 @@
 #include <iostream>
 #include <map>
 #include <vector>
+#include <set>
+#include <tuple>
+#include <cfloat>
 using namespace std;
 
 unsigned int TextureFromFile(const char* path, const string& directory, bool gamma = false);
 
+// 阴影代理网格的顶点聚类精度：包围盒最长边划分的格数
+const int SHADOW_PROXY_GRID = 64;
+
 class Model
 {
 public:
@@ -33,11 +39,18 @@ public:
     vector<Mesh>    meshes;
     string directory;
     bool gltf;
+    // 模型空间包围盒（gltf 已烘焙节点变换，即为网格顶点的包围盒）
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+    // 自动生成的阴影代理网格（所有非玻璃网格合并后顶点聚类简化），没有明显简化时为 0
+    unsigned int shadowProxyVAO = 0;
+    unsigned int shadowProxyIndexCount = 0;
 
     // 构造函数，传入模型文件路径，确定是否加载gltf模型
     Model(string const& path, bool gltf = false) : gltf(gltf)
     {    
         loadModel(path); // 初始化模型矩阵
+        buildShadowProxy();
     }
 
     // 绘制模型
@@ -55,6 +68,48 @@ public:
             meshes[i].Draw(shader);
     }
 
+    // 只绘制不透明网格，透明网格由透明通道排序后单独绘制
+    void DrawOpaque(Shader& shader)
+    {
+        shader.setBool("gltf", gltf);
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            if (!meshes[i].isTransparent())
+                meshes[i].Draw(shader);
+        }
+    }
+
+    // 深度预通道：只提交不透明网格的位置流
+    void DrawOpaquePositions()
+    {
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            if (!meshes[i].isTransparent())
+                meshes[i].DrawPositions();
+        }
+    }
+
+    // 阴影渲染：只提交位置流，有代理网格时一次绘制整个模型
+    void DrawShadow(bool useProxy)
+    {
+        if (useProxy && shadowProxyVAO != 0)
+        {
+            glBindVertexArray(shadowProxyVAO);
+            glDrawElements(GL_TRIANGLES, shadowProxyIndexCount, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+            return;
+        }
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            if (!meshes[i].isGlass) // 玻璃不参与深度贴图渲染
+                meshes[i].DrawPositions();
+        }
+    }
+
+    // 包围球（模型空间）
+    glm::vec3 boundsCenter() const { return (boundsMin + boundsMax) * 0.5f; }
+    float boundsRadius() const { return glm::length(boundsMax - boundsMin) * 0.5f; }
+
 private:
     // 加载模型
     void loadModel(string const& path)
@@ -96,6 +151,89 @@ private:
         }
     }
 
+    // 顶点聚类：包围盒按 SHADOW_PROXY_GRID 划分网格，同一格内的顶点合并到平均位置，丢弃退化和重复的三角形
+    // 误差没有上界保证：投射面最多移动一个格子对角线（2 米的模型约 5 厘米），远大于点光源阴影偏移 0.005~0.015，
+    // 会出现自阴影条纹和阴影脱离，所以默认不用（F6 打开），只适合对比开销或离光源很远的投射体
+    void buildShadowProxy()
+    {
+        glm::vec3 extent = boundsMax - boundsMin;
+        float cellSize = glm::max(glm::max(extent.x, extent.y), extent.z) / SHADOW_PROXY_GRID;
+        if (!(cellSize > 0.0f)) return;
+
+        map<tuple<int, int, int>, unsigned int> clusters;
+        vector<glm::vec3> sums;
+        vector<unsigned int> counts;
+        vector<unsigned int> proxyIndices;
+        set<tuple<unsigned int, unsigned int, unsigned int>> triangles;
+        size_t sourceTriangles = 0;
+        size_t fullBytes = 0, packedBytes = 0;
+        for (const Mesh& mesh : meshes)
+        {
+            if (mesh.isGlass) continue;
+            fullBytes += mesh.vertices.size() * sizeof(Vertex);
+            packedBytes += mesh.positionVertexCount * sizeof(glm::vec3);
+
+            vector<unsigned int> remap(mesh.vertices.size());
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+            {
+                glm::ivec3 cell = glm::ivec3(glm::floor((mesh.vertices[i].Position - boundsMin) / cellSize));
+                auto key = make_tuple(cell.x, cell.y, cell.z);
+                auto it = clusters.find(key);
+                if (it == clusters.end())
+                {
+                    it = clusters.insert({ key, (unsigned int)sums.size() }).first;
+                    sums.push_back(glm::vec3(0.0f));
+                    counts.push_back(0);
+                }
+                sums[it->second] += mesh.vertices[i].Position;
+                counts[it->second]++;
+                remap[i] = it->second;
+            }
+
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+            {
+                sourceTriangles++;
+                unsigned int a = remap[mesh.indices[i]], b = remap[mesh.indices[i + 1]], c = remap[mesh.indices[i + 2]];
+                if (a == b || b == c || a == c) continue;
+                // 旋转到最小下标开头再去重，保留绕序（阴影通道剔除正面）
+                while (a > b || a > c) { unsigned int t = a; a = b; b = c; c = t; }
+                if (!triangles.insert(make_tuple(a, b, c)).second) continue;
+                proxyIndices.push_back(a);
+                proxyIndices.push_back(b);
+                proxyIndices.push_back(c);
+            }
+        }
+
+        size_t proxyTriangles = proxyIndices.size() / 3;
+        cout << "[Shadow] " << directory << ": position stream " << fullBytes / 1024 << " KB -> " << packedBytes / 1024
+             << " KB, proxy " << sourceTriangles << " -> " << proxyTriangles << " triangles (cell " << cellSize << ")";
+        // 简化不到 3/4 的模型直接用位置流，不值得多一份几何
+        if (proxyTriangles == 0 || proxyTriangles * 4 > sourceTriangles * 3)
+        {
+            cout << " (proxy skipped)" << endl;
+            return;
+        }
+        cout << endl;
+
+        vector<glm::vec3> positions(sums.size());
+        for (size_t i = 0; i < sums.size(); i++)
+            positions[i] = sums[i] / (float)counts[i];
+
+        unsigned int proxyVBO, proxyEBO;
+        glGenVertexArrays(1, &shadowProxyVAO);
+        glGenBuffers(1, &proxyVBO);
+        glGenBuffers(1, &proxyEBO);
+        glBindVertexArray(shadowProxyVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, proxyVBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, proxyEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, proxyIndices.size() * sizeof(unsigned int), &proxyIndices[0], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glBindVertexArray(0);
+        shadowProxyIndexCount = (unsigned int)proxyIndices.size();
+    }
+
     // 处理节点
     void processNode(aiNode* node, const aiScene* scene)
     {
@@ -129,6 +267,8 @@ private:
             vector.y = mesh->mVertices[i].y;
             vector.z = mesh->mVertices[i].z;
             vertex.Position = vector;
+            boundsMin = glm::min(boundsMin, vector);
+            boundsMax = glm::max(boundsMax, vector);
 
             // 法线
             if (mesh->HasNormals())
@@ -0,0 +1,64 @@
+#ifndef OIT_H
+#define OIT_H
+
+#include <glad/glad.h>
+
+#include <shader.h>
+#include "render_graph.h"
+
+#include <functional>
+
+// 加权混合顺序无关透明（Weighted Blended OIT, McGuire & Bavoil 2013）
+// GL 3.3 没有逐附件的混合函数，两个附件共用 glBlendFuncSeparate(ONE, ONE, ZERO, ONE_MINUS_SRC_ALPHA)：
+//   accum  (RGBA16F): rgb 累加 C * a * w，alpha 连乘 (1 - a) 得到透过率
+//   weight (R16F)   : r 累加 a * w
+// 每个透明片段的开销固定，不需要在 CPU 上排序，最后一次全屏合成
+// 累积缓冲和深度副本都是渲染图的临时纹理
+void addWeightedOITPasses(Shader& compositeShader, RGHandle sceneColor, RGHandle sceneDepth, int width, int height, std::function<void()> drawTransparent);
+
+// 声明三个通道：复制不透明场景深度 -> 累积（drawTransparent 画全部透明物体）-> 合成到场景渲染目标
+void addWeightedOITPasses(Shader& compositeShader, RGHandle sceneColor, RGHandle sceneDepth, int width, int height, std::function<void()> drawTransparent)
+{
+	RGTextureDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.internalFormat = GL_DEPTH24_STENCIL8; // 与场景深度一致才能 blit，用于遮挡透明物体
+	RGHandle depth = rgCreateTexture("oit depth", desc);
+	desc.internalFormat = GL_RGBA16F;
+	RGHandle accum = rgCreateTexture("oit accum", desc);
+	desc.internalFormat = GL_R16F;
+	RGHandle weight = rgCreateTexture("oit weight", desc);
+
+	rgAddPass("oit depth", { sceneDepth }, {}, depth, [=]() {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, rgFramebuffer({}, sceneDepth));
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	});
+
+	rgAddPass("oit accumulate", { depth }, { accum, weight }, depth, [=]() {
+		const float clearAccum[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		const float clearWeight[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		glClearBufferfv(GL_COLOR, 0, clearAccum);
+		glClearBufferfv(GL_COLOR, 1, clearWeight);
+
+		glEnable(GL_BLEND);
+		glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+		drawTransparent();
+		glDepthMask(GL_TRUE);
+	});
+
+	// 合成：加权平均颜色按覆盖率混合到不透明场景上
+	rgAddPass("oit composite", { accum, weight, sceneColor }, { sceneColor }, RG_NONE, [=, &compositeShader]() {
+		glDisable(GL_DEPTH_TEST);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		compositeShader.use();
+		glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, rgTexture(accum));
+		glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, rgTexture(weight));
+		renderQuad();
+
+		glEnable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+	});
+}
+#endif
@@ -0,0 +1,119 @@
+#ifndef POST_PROCESS_H
+#define POST_PROCESS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <shader.h>
+#include "render_graph.h"
+
+#include <string>
+#include <vector>
+
+// 后处理：场景（及 TAA）都在线性 HDR 里完成，帧末一个全屏通道把它放大到窗口，并叠加泛光、曝光、
+// 色调映射和 gamma 校正，每个窗口像素只做一次（透明物体也在线性空间里混合）
+// 泛光是从半分辨率开始的降采样链，逐级降采样后再逐级上采样累加回第 0 级，各级都是渲染图的临时纹理
+const int BLOOM_MIP_COUNT = 5;
+const float BLOOM_INTENSITY = 0.04f;
+
+struct PostProcess
+{
+	bool bloom = true;
+	float exposure = 1.0f;
+};
+PostProcess postProcess;
+
+RGHandle addBloomPasses(Shader& downsampleShader, Shader& upsampleShader, RGHandle hdrColor, int width, int height);
+void addPostProcessPass(Shader& postShader, Shader& bloomDownsampleShader, Shader& bloomUpsampleShader, RGHandle hdrColor, int width, int height, int windowWidth, int windowHeight);
+
+// 泛光：hdrColor -> 第 0 级 -> ... -> 最后一级逐级降采样，再从最小一级开始帐篷滤波上采样、加法混合到上一级
+// 返回第 0 级（半分辨率）
+RGHandle addBloomPasses(Shader& downsampleShader, Shader& upsampleShader, RGHandle hdrColor, int width, int height)
+{
+	RGHandle mips[BLOOM_MIP_COUNT];
+	RGTextureDesc desc;
+	desc.internalFormat = GL_R11F_G11F_B10F;
+	desc.filter = GL_LINEAR;
+	glm::ivec2 size(width, height);
+	for (int i = 0; i < BLOOM_MIP_COUNT; ++i)
+	{
+		size = glm::max((size + 1) / 2, glm::ivec2(1));
+		desc.width = size.x;
+		desc.height = size.y;
+		mips[i] = rgCreateTexture("bloom " + std::to_string(i), desc);
+	}
+
+	for (int i = 0; i < BLOOM_MIP_COUNT; ++i)
+	{
+		RGHandle source = i == 0 ? hdrColor : mips[i - 1];
+		rgAddPass("bloom down " + std::to_string(i), { source }, { mips[i] }, RG_NONE, [=, &downsampleShader]() {
+			if (i == 0) beginGpuTimer("bloom");
+			glDisable(GL_DEPTH_TEST);
+			downsampleShader.use();
+			downsampleShader.setInt("sourceTexture", 0);
+			downsampleShader.setVec2("sourceTexel", 1.0f / rgDesc(source).width, 1.0f / rgDesc(source).height);
+			downsampleShader.setBool("firstLevel", i == 0);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, rgTexture(source));
+			renderQuad();
+			glEnable(GL_DEPTH_TEST);
+		});
+	}
+
+	for (int i = BLOOM_MIP_COUNT - 1; i > 0; --i)
+	{
+		RGHandle source = mips[i];
+		RGHandle target = mips[i - 1];
+		rgAddPass("bloom up " + std::to_string(i - 1), { source, target }, { target }, RG_NONE, [=, &upsampleShader]() {
+			glDisable(GL_DEPTH_TEST);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			upsampleShader.use();
+			upsampleShader.setInt("sourceTexture", 0);
+			upsampleShader.setVec2("sourceTexel", 1.0f / rgDesc(source).width, 1.0f / rgDesc(source).height);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, rgTexture(source));
+			renderQuad();
+			glDisable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glEnable(GL_DEPTH_TEST);
+			if (i == 1) endGpuTimer();
+		});
+	}
+	return mips[0];
+}
+
+// 帧末声明：hdrColor 为渲染分辨率 (width x height) 的线性 HDR 颜色，结果写到窗口（默认帧缓冲）
+// 泛光通道总是声明，关闭泛光时后处理不读它，由渲染图剔除
+void addPostProcessPass(Shader& postShader, Shader& bloomDownsampleShader, Shader& bloomUpsampleShader, RGHandle hdrColor, int width, int height, int windowWidth, int windowHeight)
+{
+	RGHandle bloom = addBloomPasses(bloomDownsampleShader, bloomUpsampleShader, hdrColor, width, height);
+	RGHandle window = rgImportTexture("window", 0, windowWidth, windowHeight, GL_RGBA8);
+	bool useBloom = postProcess.bloom;
+	float exposure = postProcess.exposure;
+
+	std::vector<RGHandle> reads = { hdrColor };
+	if (useBloom) reads.push_back(bloom);
+	rgAddPass("post", reads, { window }, RG_NONE, [=, &postShader]() {
+		beginGpuTimer("post");
+		glDisable(GL_DEPTH_TEST);
+		postShader.use();
+		postShader.setInt("sceneColor", 0);
+		postShader.setInt("bloomTexture", 1);
+		postShader.setVec2("sourceSize", (float)width, (float)height);
+		postShader.setBool("upscale", width != windowWidth || height != windowHeight);
+		postShader.setBool("useBloom", useBloom);
+		postShader.setFloat("bloomIntensity", BLOOM_INTENSITY);
+		postShader.setInt("bloomLevels", BLOOM_MIP_COUNT);
+		postShader.setFloat("exposure", exposure);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(hdrColor));
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, useBloom ? rgTexture(bloom) : 0);
+		renderQuad();
+		glEnable(GL_DEPTH_TEST);
+		endGpuTimer();
+	});
+}
+#endif
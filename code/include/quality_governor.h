@@ -0,0 +1,143 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <glm/glm.hpp>
+
+#include "shadow_scheduler.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+// 画质调节器：让帧时间保持在目标附近
+// 超时先降渲染分辨率（场景目标缩小后放大到窗口，见 scene_target.h），降到下限仍超时再按顺序关掉几项画质；
+// 有余量时逆序恢复：先恢复画质项，再提高分辨率。每次调整都打印出来便于调参
+// 帧时间取一段时间内的平均值（渲染循环不限帧，平均帧时间即 CPU/GPU 中较慢的一方）
+const double QUALITY_TARGET_MS = 1000.0 / 60.0;
+const double QUALITY_EVAL_INTERVAL_MS = 500.0; // 累计这么多帧时间评估一次
+const double QUALITY_MAX_SAMPLE_MS = 250.0;    // 超过的帧当作卡顿（加载、拖动窗口）不计入
+const double QUALITY_OVER_BUDGET = 1.05;       // 平均帧时间 / 目标超过该值时降级
+const double QUALITY_UNDER_BUDGET = 0.8;       // 低于该值时升级，两者之间不动，防止来回切换
+const float RENDER_SCALE_MIN = 0.5f;
+const float RENDER_SCALE_STEP = 0.05f;         // 渲染比例按该步长取整，避免频繁重建渲染目标
+
+// 分辨率到下限后依次降级的画质项（level 为已降级的项数）
+const int QUALITY_LEVEL_COUNT = 4;
+const int POM_MAX_STEPS_HIGH = 14;
+const int POM_MAX_STEPS_LOW = 8;
+const int PCF_TAPS_HIGH = 8;
+const int PCF_TAPS_LOW = 4;
+const float LOD_DISTANCE_SCALE_LOW = 0.6f;     // 替身切换距离缩放
+static const char* qualityLevelNames[QUALITY_LEVEL_COUNT] = {
+	"POM steps 14 -> 8",
+	"PCF taps 8 -> 4",
+	"shadow update budget x0.5",
+	"impostor LOD distance x0.6",
+};
+
+struct QualityGovernor
+{
+	bool enabled = true;
+	double targetMs = QUALITY_TARGET_MS;
+	float renderScale = 1.0f;
+	int level = 0;
+
+	double accumulatedMs = 0.0;
+	int frames = 0;
+
+	// 当前生效的画质设置，由 level 决定
+	int pomMaxSteps = POM_MAX_STEPS_HIGH;
+	int pcfTaps = PCF_TAPS_HIGH;
+	float lodDistanceScale = 1.0f;
+};
+QualityGovernor qualityGovernor;
+
+void applyQualityLevel();
+void updateQualityGovernor(double frameMs);
+void setQualityGovernorEnabled(bool enabled);
+
+void applyQualityLevel()
+{
+	QualityGovernor& g = qualityGovernor;
+	g.pomMaxSteps = g.level >= 1 ? POM_MAX_STEPS_LOW : POM_MAX_STEPS_HIGH;
+	g.pcfTaps = g.level >= 2 ? PCF_TAPS_LOW : PCF_TAPS_HIGH;
+	shadowUpdateBudget.targetMs = g.level >= 3 ? SHADOW_UPDATE_TARGET_MS * 0.5 : SHADOW_UPDATE_TARGET_MS;
+	g.lodDistanceScale = g.level >= 4 ? LOD_DISTANCE_SCALE_LOW : 1.0f;
+}
+
+static void logQualityDecision(double averageMs, const char* action)
+{
+	std::cout << "[Quality] " << std::fixed << std::setprecision(1) << averageMs << " ms (target "
+		<< qualityGovernor.targetMs << "): " << action << std::defaultfloat << std::endl;
+}
+
+static void setRenderScale(double averageMs, float scale)
+{
+	QualityGovernor& g = qualityGovernor;
+	std::cout << "[Quality] " << std::fixed << std::setprecision(1) << averageMs << " ms (target " << g.targetMs
+		<< "): render scale " << std::setprecision(2) << g.renderScale << " -> " << scale << std::defaultfloat << std::endl;
+	g.renderScale = scale;
+}
+
+// 每帧调用，frameMs 为上一帧的帧时间
+void updateQualityGovernor(double frameMs)
+{
+	QualityGovernor& g = qualityGovernor;
+	if (!g.enabled || frameMs > QUALITY_MAX_SAMPLE_MS) return;
+	g.accumulatedMs += frameMs;
+	g.frames++;
+	if (g.accumulatedMs < QUALITY_EVAL_INTERVAL_MS) return;
+
+	double average = g.accumulatedMs / g.frames;
+	g.accumulatedMs = 0.0;
+	g.frames = 0;
+	double ratio = average / g.targetMs;
+
+	if (ratio > QUALITY_OVER_BUDGET)
+	{
+		if (g.renderScale > RENDER_SCALE_MIN)
+		{
+			// 像素数与比例的平方成正比，按 sqrt 估算所需比例，每次最多降 20%
+			float scale = g.renderScale * (float)glm::clamp(glm::sqrt(1.0 / ratio), 0.8, 0.95);
+			scale = glm::floor(scale / RENDER_SCALE_STEP + 0.001f) * RENDER_SCALE_STEP;
+			setRenderScale(average, glm::max(scale, RENDER_SCALE_MIN));
+		}
+		else if (g.level < QUALITY_LEVEL_COUNT)
+		{
+			logQualityDecision(average, (std::string("lower ") + qualityLevelNames[g.level]).c_str());
+			g.level++;
+			applyQualityLevel();
+		}
+	}
+	else if (ratio < QUALITY_UNDER_BUDGET)
+	{
+		if (g.level > 0)
+		{
+			g.level--;
+			applyQualityLevel();
+			logQualityDecision(average, (std::string("restore ") + qualityLevelNames[g.level]).c_str());
+		}
+		else if (g.renderScale < 1.0f)
+		{
+			float scale = g.renderScale * (float)glm::clamp(glm::sqrt(1.0 / ratio), 1.02, 1.1);
+			scale = glm::ceil(scale / RENDER_SCALE_STEP - 0.001f) * RENDER_SCALE_STEP;
+			setRenderScale(average, glm::min(scale, 1.0f));
+		}
+	}
+}
+
+// 关闭时恢复满分辨率和全部画质项
+void setQualityGovernorEnabled(bool enabled)
+{
+	QualityGovernor& g = qualityGovernor;
+	g.enabled = enabled;
+	g.accumulatedMs = 0.0;
+	g.frames = 0;
+	if (!enabled)
+	{
+		g.renderScale = 1.0f;
+		g.level = 0;
+		applyQualityLevel();
+	}
+}
+#endif
@@ -0,0 +1,313 @@
+#ifndef REFLECTION_PROBES_H
+#define REFLECTION_PROBES_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <shader.h>
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <cfloat>
+
+// 局部反射探针：图书馆内部按网格摆放立方体贴图探针，镜面 IBL 改用探针代替室外街景的 prefilterMap
+// 采样时用盒投影做视差校正：反射光线与探针的投影盒（房间）求交，再从探针位置看向交点
+// 显存来自固定预算的槽位：每个槽位一张捕获立方体贴图 + 一张预滤波立方体贴图，离相机最近的探针占用槽位
+// 捕获和 GGX 预滤波复用 skybox.h 的 captureViews / prefilterCubemapMip，按帧分摊：每帧只画一个面或预滤波一级 mip，
+// 一个探针 6 + 1 + REFLECTION_PROBE_MIPS 帧更新完；只有附近物体新增/移动/删除（updateShadowCache 检测）时才重新捕获
+// GL 3.3 没有立方体贴图数组，槽位是独立的立方体贴图，各占一个纹理单元，需要 GL_MAX_TEXTURE_IMAGE_UNITS > 21
+const int REFLECTION_PROBE_BUDGET = 4;        // 槽位数，与 pbr_lighting.glsl 的 MAX_REFLECTION_PROBES 一致
+const int REFLECTION_PROBE_SIZE = 128;
+const int REFLECTION_PROBE_MIPS = 5;          // 与 createPrefilterMap 相同的粗糙度分级
+const int REFLECTION_PROBE_TEXTURE_UNIT = 18; // 18 ~ 18 + BUDGET - 1
+const int REFLECTION_PROBE_FALLBACK_UNIT = 1; // 单元不够时不创建探针，采样器改指同为立方体贴图的 prefilterMap 单元
+const int REFLECTION_PROBE_GRID = 3;          // 每个水平方向的探针数
+const float REFLECTION_PROBE_HEIGHT = 2.0f;   // 捕获点离地高度，大致是视线高度
+const float REFLECTION_PROBE_FADE = 2.0f;     // 影响范围外扩的渐变宽度，相邻探针在边界处各占一半
+const float REFLECTION_PROBE_CAPTURE_RADIUS = 4.0f; // 影响范围外扩这么远内的物体变化才重新捕获，更远的在立方体贴图里只占很小一块
+const float REFLECTION_PROBE_NEAR = 0.1f;
+const float REFLECTION_PROBE_FAR = 100.0f;
+
+// 每帧一步：0~5 捕获第 i 面，6 生成捕获贴图的 mipmap（预滤波按采样密度取 mip），之后每步预滤波一级
+const int REFLECTION_STEP_MIPMAP = 6;
+const int REFLECTION_STEP_COUNT = REFLECTION_STEP_MIPMAP + 1 + REFLECTION_PROBE_MIPS;
+
+struct ReflectionProbe
+{
+	glm::vec3 position;
+	glm::vec3 influenceMin, influenceMax; // 不含渐变的影响范围
+	glm::vec3 boxMin, boxMax;             // 视差校正用的投影盒
+	int slot = -1;      // 占用的槽位，-1 表示未驻留
+	bool valid = false; // 槽位里是否已有完整的预滤波结果
+	bool dirty = true;
+};
+
+struct ReflectionProbeSlot
+{
+	unsigned int capture = 0;     // RGB16F，带 mipmap
+	unsigned int prefiltered = 0; // RGB16F，REFLECTION_PROBE_MIPS 级
+	int probe = -1;
+};
+
+struct ReflectionProbes
+{
+	std::vector<ReflectionProbe> probes;
+	ReflectionProbeSlot slots[REFLECTION_PROBE_BUDGET];
+	unsigned int fbo = 0, depthRbo = 0;
+	int active = -1; // 正在分摊更新的探针
+	int step = 0;
+	bool enabled = true;
+
+	// 统计（printReflectionProbeStats 打印后清零）
+	int steps = 0;
+	int captures = 0;
+};
+ReflectionProbes reflectionProbes;
+
+void initReflectionProbes(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+void invalidateReflectionProbes(const glm::vec3& worldMin, const glm::vec3& worldMax);
+void updateReflectionProbes(Shader& prefilterShader, const glm::vec3& cameraPos,
+	std::function<void(const glm::mat4& view, const glm::mat4& projection)> drawScene);
+void setReflectionProbeUniforms(Shader& shader);
+void bindReflectionProbes();
+void printReflectionProbeStats();
+void releaseReflectionProbes();
+
+static unsigned int createReflectionCubemap()
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, REFLECTION_PROBE_SIZE, REFLECTION_PROBE_SIZE, 0, GL_RGB, GL_FLOAT, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	return texture;
+}
+
+// 探针网格铺满图书馆内部，投影盒就是整个房间；槽位和捕获帧缓冲一次分配好
+void initReflectionProbes(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	int maxUnits = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+	if (maxUnits < REFLECTION_PROBE_TEXTURE_UNIT + REFLECTION_PROBE_BUDGET)
+	{
+		std::cout << "[ReflectionProbes] only " << maxUnits << " texture units, reflection probes disabled" << std::endl;
+		reflectionProbes.enabled = false;
+		return;
+	}
+
+	glm::vec3 cell = (boundsMax - boundsMin) / glm::vec3(REFLECTION_PROBE_GRID, 1.0f, REFLECTION_PROBE_GRID);
+	for (int z = 0; z < REFLECTION_PROBE_GRID; ++z)
+	{
+		for (int x = 0; x < REFLECTION_PROBE_GRID; ++x)
+		{
+			ReflectionProbe probe;
+			probe.influenceMin = boundsMin + cell * glm::vec3(x, 0.0f, z);
+			probe.influenceMax = probe.influenceMin + cell;
+			probe.position = glm::vec3((probe.influenceMin.x + probe.influenceMax.x) * 0.5f, boundsMin.y + REFLECTION_PROBE_HEIGHT,
+				(probe.influenceMin.z + probe.influenceMax.z) * 0.5f);
+			probe.boxMin = boundsMin;
+			probe.boxMax = boundsMax;
+			reflectionProbes.probes.push_back(probe);
+		}
+	}
+
+	for (ReflectionProbeSlot& slot : reflectionProbes.slots)
+	{
+		slot.capture = createReflectionCubemap();
+		slot.prefiltered = createReflectionCubemap();
+	}
+	glGenFramebuffers(1, &reflectionProbes.fbo);
+	glGenRenderbuffers(1, &reflectionProbes.depthRbo);
+	glBindRenderbuffer(GL_RENDERBUFFER, reflectionProbes.depthRbo);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, REFLECTION_PROBE_SIZE, REFLECTION_PROBE_SIZE);
+	glBindFramebuffer(GL_FRAMEBUFFER, reflectionProbes.fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, reflectionProbes.depthRbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// 物体新增/移动/删除时由 updateShadowCache 调用（新旧包围盒各一次）：包围盒碰到影响范围外扩 CAPTURE_RADIUS 的探针重新捕获
+// 不用投影盒：所有探针共用整个图书馆作投影盒，那样任何变化都会让全部探针重新捕获
+void invalidateReflectionProbes(const glm::vec3& worldMin, const glm::vec3& worldMax)
+{
+	for (ReflectionProbe& probe : reflectionProbes.probes)
+	{
+		glm::vec3 captureMin = probe.influenceMin - REFLECTION_PROBE_CAPTURE_RADIUS;
+		glm::vec3 captureMax = probe.influenceMax + REFLECTION_PROBE_CAPTURE_RADIUS;
+		if (glm::all(glm::lessThanEqual(worldMin, captureMax)) && glm::all(glm::greaterThanEqual(worldMax, captureMin)))
+			probe.dirty = true;
+	}
+}
+
+// 离相机最近的 BUDGET 个探针驻留；已驻留的保留原槽位，换进来的探针占用空出的槽位并重新捕获
+static void assignReflectionProbeSlots(const glm::vec3& cameraPos)
+{
+	ReflectionProbes& rp = reflectionProbes;
+	std::vector<int> order(rp.probes.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+	auto distance2 = [&](int i) {
+		glm::vec3 d = glm::clamp(cameraPos, rp.probes[i].influenceMin, rp.probes[i].influenceMax) - cameraPos;
+		return glm::dot(d, d);
+	};
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return distance2(a) < distance2(b); });
+	order.resize(std::min<size_t>(order.size(), REFLECTION_PROBE_BUDGET));
+
+	for (ReflectionProbeSlot& slot : rp.slots)
+	{
+		if (slot.probe < 0 || std::find(order.begin(), order.end(), slot.probe) != order.end()) continue;
+		ReflectionProbe& evicted = rp.probes[slot.probe];
+		evicted.slot = -1;
+		evicted.valid = false;
+		evicted.dirty = true;
+		if (rp.active == slot.probe) rp.active = -1;
+		slot.probe = -1;
+	}
+	for (int index : order)
+	{
+		ReflectionProbe& probe = rp.probes[index];
+		if (probe.slot >= 0) continue;
+		for (int s = 0; s < REFLECTION_PROBE_BUDGET; ++s)
+		{
+			if (rp.slots[s].probe >= 0) continue;
+			rp.slots[s].probe = index;
+			probe.slot = s;
+			probe.dirty = true;
+			break;
+		}
+	}
+}
+
+// 每帧在主场景之前调用，推进一步；drawScene 用给定的 view/projection 画不透明场景和天空盒（当前帧缓冲已绑好并清空）
+// 先选没有有效结果的探针，其次离相机最近的脏探针
+void updateReflectionProbes(Shader& prefilterShader, const glm::vec3& cameraPos,
+	std::function<void(const glm::mat4& view, const glm::mat4& projection)> drawScene)
+{
+	ReflectionProbes& rp = reflectionProbes;
+	if (!rp.enabled || rp.probes.empty()) return;
+	assignReflectionProbeSlots(cameraPos);
+
+	if (rp.active < 0)
+	{
+		float best = FLT_MAX;
+		for (int i = 0; i < (int)rp.probes.size(); ++i)
+		{
+			const ReflectionProbe& probe = rp.probes[i];
+			if (probe.slot < 0 || !probe.dirty) continue;
+			glm::vec3 d = probe.position - cameraPos;
+			float score = glm::dot(d, d) + (probe.valid ? 1e6f : 0.0f);
+			if (score < best)
+			{
+				best = score;
+				rp.active = i;
+			}
+		}
+		if (rp.active < 0) return;
+		rp.probes[rp.active].dirty = false; // 更新途中再被标脏的话，结束后重新排队
+		rp.step = 0;
+	}
+
+	ReflectionProbe& probe = rp.probes[rp.active];
+	ReflectionProbeSlot& slot = rp.slots[probe.slot];
+	if (rp.step < REFLECTION_STEP_MIPMAP)
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, REFLECTION_PROBE_NEAR, REFLECTION_PROBE_FAR);
+		glm::mat4 view = captureViews[rp.step] * glm::translate(glm::mat4(1.0f), -probe.position);
+		glBindFramebuffer(GL_FRAMEBUFFER, rp.fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + rp.step, slot.capture, 0);
+		glViewport(0, 0, REFLECTION_PROBE_SIZE, REFLECTION_PROBE_SIZE);
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawScene(view, projection);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	else if (rp.step == REFLECTION_STEP_MIPMAP)
+	{
+		glBindTexture(GL_TEXTURE_CUBE_MAP, slot.capture);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	}
+	else
+	{
+		unsigned int mip = rp.step - REFLECTION_STEP_MIPMAP - 1;
+		prefilterCubemapMip(prefilterShader, slot.capture, REFLECTION_PROBE_SIZE, slot.prefiltered, REFLECTION_PROBE_SIZE, mip, REFLECTION_PROBE_MIPS);
+	}
+	rp.steps++;
+
+	if (++rp.step == REFLECTION_STEP_COUNT)
+	{
+		probe.valid = true;
+		rp.active = -1;
+		rp.captures++;
+	}
+}
+
+// 驻留且有效的探针按槽位上传；无效槽位 w = 0，着色器跳过
+void setReflectionProbeUniforms(Shader& shader)
+{
+	const ReflectionProbes& rp = reflectionProbes;
+	shader.setBool("useReflectionProbes", rp.enabled && !rp.probes.empty());
+	shader.setFloat("reflectionProbeFade", REFLECTION_PROBE_FADE);
+	for (int s = 0; s < REFLECTION_PROBE_BUDGET; ++s)
+	{
+		std::string index = "[" + std::to_string(s) + "]";
+		shader.setInt("reflectionProbes" + index, !rp.probes.empty() ? REFLECTION_PROBE_TEXTURE_UNIT + s : REFLECTION_PROBE_FALLBACK_UNIT);
+		const ReflectionProbeSlot& slot = rp.slots[s];
+		bool valid = slot.probe >= 0 && rp.probes[slot.probe].valid;
+		ReflectionProbe probe = slot.probe >= 0 ? rp.probes[slot.probe] : ReflectionProbe();
+		shader.setVec4("reflectionProbePosition" + index, glm::vec4(probe.position, valid ? 1.0f : 0.0f));
+		shader.setVec3("reflectionProbeBoxMin" + index, probe.boxMin);
+		shader.setVec3("reflectionProbeBoxMax" + index, probe.boxMax);
+		shader.setVec3("reflectionProbeInfluenceMin" + index, probe.influenceMin - REFLECTION_PROBE_FADE);
+		shader.setVec3("reflectionProbeInfluenceMax" + index, probe.influenceMax + REFLECTION_PROBE_FADE);
+	}
+}
+
+void bindReflectionProbes()
+{
+	if (reflectionProbes.probes.empty()) return;
+	for (int s = 0; s < REFLECTION_PROBE_BUDGET; ++s)
+	{
+		glActiveTexture(GL_TEXTURE0 + REFLECTION_PROBE_TEXTURE_UNIT + s);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, reflectionProbes.slots[s].prefiltered);
+	}
+}
+
+void printReflectionProbeStats()
+{
+	ReflectionProbes& rp = reflectionProbes;
+	int resident = 0, valid = 0, dirty = 0;
+	for (const ReflectionProbe& probe : rp.probes)
+	{
+		resident += probe.slot >= 0;
+		valid += probe.valid;
+		dirty += probe.dirty;
+	}
+	std::cout << "[ReflectionProbes] resident: " << resident << "/" << rp.probes.size()
+		<< "  valid: " << valid << "  dirty: " << dirty
+		<< "  steps: " << rp.steps << "  captures: " << rp.captures << std::endl;
+	rp.steps = 0;
+	rp.captures = 0;
+}
+
+void releaseReflectionProbes()
+{
+	for (ReflectionProbeSlot& slot : reflectionProbes.slots)
+	{
+		glDeleteTextures(1, &slot.capture);
+		glDeleteTextures(1, &slot.prefiltered);
+	}
+	glDeleteFramebuffers(1, &reflectionProbes.fbo);
+	glDeleteRenderbuffers(1, &reflectionProbes.depthRbo);
+}
+#endif
@@ -0,0 +1,481 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+// 渲染图：每帧先声明各通道读写的纹理，再统一编译、执行
+// - 排序：按读写关系（写后读、写后写、读后写）拓扑排序，同等条件下保持声明顺序
+// - 剔除：从写导入资源（场景目标、TAA 历史、窗口）的通道往回找，结果没人用的通道不执行
+// - 别名：临时纹理只在本帧内有效，生命周期不重叠且尺寸/格式相同的共用同一个 GL 纹理
+//   （GL 3.3 没有显式的内存别名，只能复用整个纹理对象），纹理和 FBO 都留在池里跨帧复用
+// 通道的颜色/深度输出由图绑定好 FBO 和视口；深度测试、混合或保留旧内容的写入同时也是读，要列在 reads 里
+typedef int RGHandle;
+const RGHandle RG_NONE = -1;
+const int RG_POOL_KEEP_FRAMES = 30; // 池里的纹理连续这么多帧没用到就释放
+
+struct RGTextureDesc
+{
+	int width = 0;
+	int height = 0;
+	GLenum internalFormat = GL_RGBA8;
+	GLenum filter = GL_NEAREST;
+};
+
+struct RGResource
+{
+	std::string name;
+	RGTextureDesc desc;
+	bool imported = false;
+	unsigned int texture = 0; // 导入的 0 表示默认帧缓冲（窗口）
+	int firstUse = -1;        // 执行顺序中的下标
+	int lastUse = -1;
+	int physical = -1;        // 临时纹理在池里的下标
+};
+
+struct RGPass
+{
+	std::string name;
+	std::vector<RGHandle> reads;
+	std::vector<RGHandle> colorWrites;
+	RGHandle depthWrite = RG_NONE;
+	std::function<void()> execute;
+	bool culled = false;
+};
+
+struct RGPooledTexture
+{
+	RGTextureDesc desc;
+	unsigned int texture = 0;
+	int busyUntil = -1;       // 本帧内被占用到哪个通道
+	unsigned long long lastFrame = 0;
+};
+
+struct RenderGraph
+{
+	std::vector<RGResource> resources;
+	std::vector<RGPass> passes;
+	std::vector<int> order;   // 编译后的执行顺序（不含被剔除的通道）
+	std::vector<RGPooledTexture> pool;
+	std::map<std::vector<unsigned int>, unsigned int> framebuffers; // 附件纹理 -> FBO
+	unsigned long long frame = 0;
+	bool dumpNextFrame = false;
+
+	// 统计，供每秒打印
+	size_t transientBytes = 0; // 不共用时临时纹理需要的显存
+	size_t physicalBytes = 0;  // 本帧实际用到的池纹理显存
+	int culledPasses = 0;
+};
+RenderGraph renderGraph;
+
+void beginRenderGraph();
+RGHandle rgCreateTexture(const std::string& name, const RGTextureDesc& desc);
+RGHandle rgImportTexture(const std::string& name, unsigned int texture, int width, int height, GLenum internalFormat);
+void rgAddPass(const std::string& name, const std::vector<RGHandle>& reads, const std::vector<RGHandle>& colorWrites, RGHandle depthWrite, std::function<void()> execute);
+unsigned int rgTexture(RGHandle handle);
+unsigned int rgFramebuffer(const std::vector<RGHandle>& colorAttachments, RGHandle depthAttachment);
+const RGTextureDesc& rgDesc(RGHandle handle);
+void compileRenderGraph();
+void executeRenderGraph();
+void dumpRenderGraph();
+void printRenderGraphStats();
+void releaseRenderGraph();
+
+static void rgFormatInfo(GLenum internalFormat, GLenum& format, GLenum& type, int& bytesPerPixel)
+{
+	switch (internalFormat)
+	{
+	case GL_RGBA16F:           format = GL_RGBA; type = GL_FLOAT; bytesPerPixel = 8; break;
+	case GL_RG16F:             format = GL_RG; type = GL_FLOAT; bytesPerPixel = 4; break;
+	case GL_R16F:              format = GL_RED; type = GL_FLOAT; bytesPerPixel = 2; break;
+	case GL_RG16:              format = GL_RG; type = GL_UNSIGNED_SHORT; bytesPerPixel = 4; break;
+	case GL_R11F_G11F_B10F:    format = GL_RGB; type = GL_FLOAT; bytesPerPixel = 4; break;
+	case GL_DEPTH24_STENCIL8:  format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; bytesPerPixel = 4; break;
+	case GL_DEPTH_COMPONENT24: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; bytesPerPixel = 4; break;
+	default:                   format = GL_RGBA; type = GL_UNSIGNED_BYTE; bytesPerPixel = 4; break; // GL_RGBA8
+	}
+}
+
+static size_t rgTextureBytes(const RGTextureDesc& desc)
+{
+	GLenum format, type;
+	int bytesPerPixel;
+	rgFormatInfo(desc.internalFormat, format, type, bytesPerPixel);
+	return (size_t)desc.width * desc.height * bytesPerPixel;
+}
+
+static bool rgSameDesc(const RGTextureDesc& a, const RGTextureDesc& b)
+{
+	return a.width == b.width && a.height == b.height && a.internalFormat == b.internalFormat && a.filter == b.filter;
+}
+
+// 每帧开始声明通道前调用
+void beginRenderGraph()
+{
+	renderGraph.resources.clear();
+	renderGraph.passes.clear();
+	renderGraph.order.clear();
+	renderGraph.frame++;
+}
+
+// 本帧的临时纹理，编译时才分配（或从池里借用）
+RGHandle rgCreateTexture(const std::string& name, const RGTextureDesc& desc)
+{
+	RGResource resource;
+	resource.name = name;
+	resource.desc = desc;
+	renderGraph.resources.push_back(resource);
+	return (RGHandle)renderGraph.resources.size() - 1;
+}
+
+// 图外管理的纹理（跨帧保留的内容），写它的通道不会被剔除；texture 为 0 表示窗口
+RGHandle rgImportTexture(const std::string& name, unsigned int texture, int width, int height, GLenum internalFormat)
+{
+	RGResource resource;
+	resource.name = name;
+	resource.desc.width = width;
+	resource.desc.height = height;
+	resource.desc.internalFormat = internalFormat;
+	resource.imported = true;
+	resource.texture = texture;
+	renderGraph.resources.push_back(resource);
+	return (RGHandle)renderGraph.resources.size() - 1;
+}
+
+void rgAddPass(const std::string& name, const std::vector<RGHandle>& reads, const std::vector<RGHandle>& colorWrites, RGHandle depthWrite, std::function<void()> execute)
+{
+	RGPass pass;
+	pass.name = name;
+	pass.reads = reads;
+	pass.colorWrites = colorWrites;
+	pass.depthWrite = depthWrite;
+	pass.execute = execute;
+	renderGraph.passes.push_back(pass);
+}
+
+// 通道执行时取纹理对象
+unsigned int rgTexture(RGHandle handle)
+{
+	return renderGraph.resources[handle].texture;
+}
+
+const RGTextureDesc& rgDesc(RGHandle handle)
+{
+	return renderGraph.resources[handle].desc;
+}
+
+// 按附件组合缓存的 FBO，通道自己需要 blit 时也可以用；附件为窗口时返回 0
+unsigned int rgFramebuffer(const std::vector<RGHandle>& colorAttachments, RGHandle depthAttachment)
+{
+	std::vector<unsigned int> key;
+	for (RGHandle handle : colorAttachments) key.push_back(rgTexture(handle));
+	key.push_back(depthAttachment == RG_NONE ? 0 : rgTexture(depthAttachment));
+	if (!colorAttachments.empty() && key[0] == 0) return 0;
+
+	auto it = renderGraph.framebuffers.find(key);
+	if (it != renderGraph.framebuffers.end()) return it->second;
+
+	// 可能在通道执行中途调用（取 blit 源），创建完恢复原来的绑定
+	GLint previousDraw, previousRead;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+	unsigned int fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	std::vector<GLenum> drawBuffers;
+	for (size_t i = 0; i < colorAttachments.size(); ++i)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + (GLenum)i, GL_TEXTURE_2D, key[i], 0);
+		drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + (GLenum)i);
+	}
+	if (depthAttachment != RG_NONE)
+	{
+		GLenum attachment = rgDesc(depthAttachment).internalFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, key.back(), 0);
+	}
+	// GL 3.3 要求没有颜色附件的 FBO 把绘制/读取缓冲设为 GL_NONE
+	if (drawBuffers.empty())
+	{
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+	else
+	{
+		glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+	}
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER:: Render graph FBO incomplete!" << std::endl;
+	}
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+	renderGraph.framebuffers[key] = fbo;
+	return fbo;
+}
+
+// 删除池纹理前先删掉引用它的 FBO
+static void rgReleasePooledTexture(RGPooledTexture& pooled)
+{
+	for (auto it = renderGraph.framebuffers.begin(); it != renderGraph.framebuffers.end();)
+	{
+		bool uses = false;
+		for (unsigned int texture : it->first) uses = uses || texture == pooled.texture;
+		if (uses)
+		{
+			glDeleteFramebuffers(1, &it->second);
+			it = renderGraph.framebuffers.erase(it);
+		}
+		else ++it;
+	}
+	glDeleteTextures(1, &pooled.texture);
+	pooled.texture = 0;
+}
+
+// 排序、剔除、计算生命周期并为临时纹理分配（别名）池纹理
+void compileRenderGraph()
+{
+	RenderGraph& g = renderGraph;
+	int passCount = (int)g.passes.size();
+
+	// 剔除：逆序扫描，needed 为后面的通道要读的资源；导入资源总是需要
+	// 通道只要写了需要的资源就保留，它覆盖掉的内容之前的写入不再需要（除非它自己也读）
+	std::vector<bool> needed(g.resources.size(), false);
+	for (size_t r = 0; r < g.resources.size(); ++r) needed[r] = g.resources[r].imported;
+	g.culledPasses = 0;
+	for (int p = passCount - 1; p >= 0; --p)
+	{
+		RGPass& pass = g.passes[p];
+		std::vector<RGHandle> writes = pass.colorWrites;
+		if (pass.depthWrite != RG_NONE) writes.push_back(pass.depthWrite);
+		bool alive = false;
+		for (RGHandle w : writes) alive = alive || needed[w];
+		pass.culled = !alive;
+		if (!alive)
+		{
+			g.culledPasses++;
+			continue;
+		}
+		for (RGHandle w : writes)
+			if (!g.resources[w].imported) needed[w] = false;
+		for (RGHandle r : pass.reads) needed[r] = true;
+	}
+
+	// 排序：依赖边只会从先声明的通道指向后声明的通道，Kahn 算法每次取入度为 0 中声明最早的
+	std::vector<std::vector<int>> edges(passCount);
+	std::vector<int> inDegree(passCount, 0);
+	std::vector<int> lastWriter(g.resources.size(), -1);
+	std::vector<std::vector<int>> readersSinceWrite(g.resources.size());
+	for (int p = 0; p < passCount; ++p)
+	{
+		const RGPass& pass = g.passes[p];
+		if (pass.culled) continue;
+		auto addEdge = [&](int from) {
+			if (from < 0 || from == p) return;
+			edges[from].push_back(p);
+			inDegree[p]++;
+		};
+		for (RGHandle r : pass.reads)
+		{
+			addEdge(lastWriter[r]);
+			readersSinceWrite[r].push_back(p);
+		}
+		std::vector<RGHandle> writes = pass.colorWrites;
+		if (pass.depthWrite != RG_NONE) writes.push_back(pass.depthWrite);
+		for (RGHandle w : writes)
+		{
+			addEdge(lastWriter[w]);
+			for (int reader : readersSinceWrite[w]) addEdge(reader);
+			readersSinceWrite[w].clear();
+			lastWriter[w] = p;
+		}
+	}
+	std::vector<bool> done(passCount, false);
+	for (int step = 0; step < passCount - g.culledPasses; ++step)
+	{
+		int next = -1;
+		for (int p = 0; p < passCount && next < 0; ++p)
+			if (!g.passes[p].culled && !done[p] && inDegree[p] == 0) next = p;
+		done[next] = true;
+		g.order.push_back(next);
+		for (int to : edges[next]) inDegree[to]--;
+	}
+
+	// 生命周期
+	for (int i = 0; i < (int)g.order.size(); ++i)
+	{
+		const RGPass& pass = g.passes[g.order[i]];
+		std::vector<RGHandle> uses = pass.reads;
+		uses.insert(uses.end(), pass.colorWrites.begin(), pass.colorWrites.end());
+		if (pass.depthWrite != RG_NONE) uses.push_back(pass.depthWrite);
+		for (RGHandle h : uses)
+		{
+			RGResource& resource = g.resources[h];
+			if (resource.firstUse < 0) resource.firstUse = i;
+			resource.lastUse = i;
+		}
+	}
+
+	// 分配：按首次使用的先后，借用同规格且已空闲的池纹理，没有就新建
+	for (RGPooledTexture& pooled : g.pool) pooled.busyUntil = -1;
+	std::vector<int> transients;
+	for (int r = 0; r < (int)g.resources.size(); ++r)
+		if (!g.resources[r].imported && g.resources[r].firstUse >= 0) transients.push_back(r);
+	std::sort(transients.begin(), transients.end(), [&](int a, int b) { return g.resources[a].firstUse < g.resources[b].firstUse; });
+
+	g.transientBytes = 0;
+	for (int r : transients)
+	{
+		RGResource& resource = g.resources[r];
+		g.transientBytes += rgTextureBytes(resource.desc);
+		int slot = -1;
+		for (int i = 0; i < (int)g.pool.size() && slot < 0; ++i)
+			if (g.pool[i].texture != 0 && g.pool[i].busyUntil < resource.firstUse && rgSameDesc(g.pool[i].desc, resource.desc)) slot = i;
+		if (slot < 0)
+		{
+			RGPooledTexture pooled;
+			pooled.desc = resource.desc;
+			GLenum format, type;
+			int bytesPerPixel;
+			rgFormatInfo(resource.desc.internalFormat, format, type, bytesPerPixel);
+			glGenTextures(1, &pooled.texture);
+			glBindTexture(GL_TEXTURE_2D, pooled.texture);
+			glTexImage2D(GL_TEXTURE_2D, 0, resource.desc.internalFormat, resource.desc.width, resource.desc.height, 0, format, type, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, resource.desc.filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, resource.desc.filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			// 空位优先复用，池下标保持稳定
+			for (int i = 0; i < (int)g.pool.size() && slot < 0; ++i)
+				if (g.pool[i].texture == 0) slot = i;
+			if (slot < 0)
+			{
+				slot = (int)g.pool.size();
+				g.pool.push_back(pooled);
+			}
+			else g.pool[slot] = pooled;
+		}
+		g.pool[slot].busyUntil = resource.lastUse;
+		g.pool[slot].lastFrame = g.frame;
+		resource.physical = slot;
+		resource.texture = g.pool[slot].texture;
+	}
+
+	// 长时间不用的池纹理（分辨率变化、切换了渲染路径）释放掉
+	g.physicalBytes = 0;
+	for (RGPooledTexture& pooled : g.pool)
+	{
+		if (pooled.texture == 0) continue;
+		if (pooled.lastFrame == g.frame) g.physicalBytes += rgTextureBytes(pooled.desc);
+		else if (g.frame - pooled.lastFrame > RG_POOL_KEEP_FRAMES) rgReleasePooledTexture(pooled);
+	}
+
+	if (g.dumpNextFrame)
+	{
+		dumpRenderGraph();
+		g.dumpNextFrame = false;
+	}
+}
+
+// 按编译好的顺序执行：绑定输出对应的 FBO 和视口（以第一个输出的尺寸为准），再调用通道
+void executeRenderGraph()
+{
+	for (int p : renderGraph.order)
+	{
+		RGPass& pass = renderGraph.passes[p];
+		RGHandle target = !pass.colorWrites.empty() ? pass.colorWrites[0] : pass.depthWrite;
+		if (target != RG_NONE)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, rgFramebuffer(pass.colorWrites, pass.depthWrite));
+			glViewport(0, 0, rgDesc(target).width, rgDesc(target).height);
+		}
+		pass.execute();
+	}
+}
+
+static const char* rgFormatName(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_RGBA16F: return "RGBA16F";
+	case GL_RG16F: return "RG16F";
+	case GL_R16F: return "R16F";
+	case GL_RG16: return "RG16";
+	case GL_R11F_G11F_B10F: return "R11G11B10F";
+	case GL_DEPTH24_STENCIL8: return "D24S8";
+	case GL_DEPTH_COMPONENT24: return "D24";
+	default: return "RGBA8";
+	}
+}
+
+// 打印本帧的通道（执行顺序、读写）、被剔除的通道、各资源的生命周期与别名情况
+void dumpRenderGraph()
+{
+	const RenderGraph& g = renderGraph;
+	auto names = [&](const std::vector<RGHandle>& handles) {
+		std::string text;
+		for (RGHandle h : handles) text += (text.empty() ? "" : ", ") + g.resources[h].name;
+		return text.empty() ? std::string("-") : text;
+	};
+
+	std::cout << "===== Render graph, frame " << g.frame << " =====" << std::endl;
+	for (size_t i = 0; i < g.order.size(); ++i)
+	{
+		const RGPass& pass = g.passes[g.order[i]];
+		std::vector<RGHandle> writes = pass.colorWrites;
+		if (pass.depthWrite != RG_NONE) writes.push_back(pass.depthWrite);
+		std::cout << std::setw(3) << i << " " << std::left << std::setw(20) << pass.name << std::right
+			<< " reads: " << names(pass.reads) << " | writes: " << names(writes) << std::endl;
+	}
+	for (const RGPass& pass : g.passes)
+		if (pass.culled) std::cout << "    culled: " << pass.name << std::endl;
+
+	std::cout << "Resources:" << std::endl;
+	for (const RGResource& resource : g.resources)
+	{
+		std::cout << "  " << std::left << std::setw(20) << resource.name << std::right << " "
+			<< resource.desc.width << "x" << resource.desc.height << " " << rgFormatName(resource.desc.internalFormat);
+		if (resource.imported) std::cout << " imported";
+		else if (resource.physical < 0) std::cout << " unused";
+		else std::cout << " passes " << resource.firstUse << "-" << resource.lastUse << " -> pool #" << resource.physical
+			<< " (" << std::fixed << std::setprecision(2) << rgTextureBytes(resource.desc) / (1024.0 * 1024.0) << " MB)" << std::defaultfloat;
+		std::cout << std::endl;
+	}
+	std::cout << "Transient memory: " << std::fixed << std::setprecision(2) << g.transientBytes / (1024.0 * 1024.0) << " MB requested, "
+		<< g.physicalBytes / (1024.0 * 1024.0) << " MB after aliasing" << std::defaultfloat << std::endl;
+}
+
+// 每秒打印一次的摘要
+void printRenderGraphStats()
+{
+	const RenderGraph& g = renderGraph;
+	size_t pooledBytes = 0;
+	int pooled = 0;
+	for (const RGPooledTexture& texture : g.pool)
+	{
+		if (texture.texture == 0) continue;
+		pooledBytes += rgTextureBytes(texture.desc);
+		pooled++;
+	}
+	std::cout << "[RenderGraph] passes: " << g.order.size() << " (culled " << g.culledPasses << ") | transient: "
+		<< std::fixed << std::setprecision(1) << g.transientBytes / (1024.0 * 1024.0) << " MB -> "
+		<< g.physicalBytes / (1024.0 * 1024.0) << " MB aliased | pool: " << pooled << " textures, "
+		<< pooledBytes / (1024.0 * 1024.0) << " MB" << std::defaultfloat << std::endl;
+}
+
+// 程序退出时释放池纹理和 FBO
+void releaseRenderGraph()
+{
+	for (RGPooledTexture& pooled : renderGraph.pool)
+		if (pooled.texture != 0) rgReleasePooledTexture(pooled);
+	for (auto& entry : renderGraph.framebuffers) glDeleteFramebuffers(1, &entry.second);
+	renderGraph.framebuffers.clear();
+	renderGraph.pool.clear();
+}
+#endif
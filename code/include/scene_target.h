@@ -0,0 +1,47 @@
+#ifndef SCENE_TARGET_H
+#define SCENE_TARGET_H
+
+#include <glad/glad.h>
+
+// 场景渲染目标：阴影以外的所有场景通道都画到这里，分辨率 = 窗口 x 渲染比例（由 quality_governor.h 调整）
+// 单采样颜色 + 深度纹理（抗锯齿交给 taa.h；深度格式与 OIT/阴影遮罩的副本一致才能 blit），每帧导入渲染图，FBO 由渲染图管理
+// 颜色是线性 HDR，曝光、色调映射、gamma 和放大到窗口都在 post_process.h 的后处理通道里做一次
+struct SceneTarget
+{
+	unsigned int colorTexture = 0; // RGBA16F，线性 HDR
+	unsigned int depthTexture = 0; // DEPTH24_STENCIL8，TAA 的运动向量通道由它重建位置
+	int width = 0;
+	int height = 0;
+};
+SceneTarget sceneTarget;
+
+void ensureSceneTarget(int width, int height);
+
+static void allocateSceneTexture(unsigned int texture, GLenum internalFormat, GLenum format, GLenum type, GLenum filter, int width, int height)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// 按渲染分辨率（重新）分配
+void ensureSceneTarget(int width, int height)
+{
+	if (sceneTarget.colorTexture != 0 && sceneTarget.width == width && sceneTarget.height == height) return;
+
+	if (sceneTarget.colorTexture == 0)
+	{
+		glGenTextures(1, &sceneTarget.colorTexture);
+		glGenTextures(1, &sceneTarget.depthTexture);
+	}
+	sceneTarget.width = width;
+	sceneTarget.height = height;
+
+	// 颜色线性过滤：放大和 TAA 历史都直接双线性取样
+	allocateSceneTexture(sceneTarget.colorTexture, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_LINEAR, width, height);
+	allocateSceneTexture(sceneTarget.depthTexture, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, GL_NEAREST, width, height);
+}
+#endif
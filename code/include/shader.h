@@ -41,8 +41,8 @@ public:
             vShaderFile.close();
             fShaderFile.close();
             // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            vertexCode = resolveIncludes(vShaderStream.str(), vertexPath);
+            fragmentCode = resolveIncludes(fShaderStream.str(), fragmentPath);
             // if geometry shader path is present, also load a geometry shader
             if (geometryPath != nullptr)
             {
@@ -50,7 +50,7 @@ public:
                 std::stringstream gShaderStream;
                 gShaderStream << gShaderFile.rdbuf();
                 gShaderFile.close();
-                geometryCode = gShaderStream.str();
+                geometryCode = resolveIncludes(gShaderStream.str(), geometryPath);
             }
         }
         catch (std::ifstream::failure& e)
@@ -162,6 +162,37 @@ public:
     }
 
 private:
+    // 展开 #include "file"（路径相对于当前着色器文件），让多个着色器共用同一份 GLSL 函数
+    // ------------------------------------------------------------------------
+    static std::string resolveIncludes(const std::string& source, const std::string& path)
+    {
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        std::istringstream input(source);
+        std::stringstream output;
+        std::string line;
+        while (std::getline(input, line))
+        {
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+            {
+                output << line << "\n";
+                continue;
+            }
+            size_t first = line.find('"', start);
+            size_t last = first == std::string::npos ? first : line.find('"', first + 1);
+            std::string includePath = last == std::string::npos ? "" : directory + line.substr(first + 1, last - first - 1);
+            std::ifstream includeFile(includePath);
+            if (!includeFile)
+            {
+                std::cout << "ERROR::SHADER::INCLUDE_NOT_FOUND: " << line << " in " << path << std::endl;
+                continue;
+            }
+            std::stringstream includeStream;
+            includeStream << includeFile.rdbuf();
+            output << resolveIncludes(includeStream.str(), includePath) << "\n";
+        }
+        return output.str();
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
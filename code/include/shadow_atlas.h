@@ -0,0 +1,197 @@
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+// 阴影图集：所有点光源的立方体面（聚光灯只有 1 个面）打包进一张 2D 深度纹理，显存固定为 SHADOW_ATLAS_SIZE^2 个纹素
+// 每个光源的面分辨率按重要性逐帧选取（SHADOW_FACE_MIN..SHADOW_FACE_MAX 之间的 2 的幂），
+// 总面积超出图集时从最不重要的光源开始降级，光源再多也不会超出预算
+const int SHADOW_ATLAS_SIZE = 4096;
+const int SHADOW_FACE_MAX = 1024;
+const int SHADOW_FACE_MIN = 128;
+
+// 点光源的四面体布局：4 个面的朝向为正四面体的面法线，每面一个非对称透视视锥，
+// 覆盖最近该法线的方向（球面三角形，角点离中心 70.5°）；视锥边界为切平面坐标 (tan) 下的三角形包围框，留了约 2% 余量
+// 与 pbr_lighting.glsl 中的 tetraFaceNormals / tetraFaceUps / TETRA_TAN_* 一致
+const glm::vec3 TETRA_FACE_NORMALS[4] = {
+	glm::vec3(0.577350f, 0.577350f, 0.577350f), glm::vec3(0.577350f, -0.577350f, -0.577350f),
+	glm::vec3(-0.577350f, 0.577350f, -0.577350f), glm::vec3(-0.577350f, -0.577350f, 0.577350f),
+};
+const glm::vec3 TETRA_FACE_UPS[4] = {
+	glm::vec3(-0.816497f, 0.408248f, 0.408248f), glm::vec3(0.408248f, -0.408248f, 0.816497f),
+	glm::vec3(0.816497f, 0.408248f, -0.408248f), glm::vec3(-0.408248f, -0.408248f, -0.816497f),
+};
+const float TETRA_TAN_X = 2.5f;      // 左右边界 ±2.5（三角形 ±2.449）
+const float TETRA_TAN_BOTTOM = -1.45f; // 三角形下边 -1.414
+const float TETRA_TAN_TOP = 2.9f;    // 三角形顶点 2.828
+
+struct ShadowAtlas
+{
+	unsigned int fbo = 0;
+	unsigned int depthTexture = 0;
+	unsigned int compareSampler = 0; // 采样器对象：同一张图集以比较模式 + 线性过滤采样（硬件 PCF）
+	bool depth16 = false; // true: DEPTH_COMPONENT16, false: DEPTH_COMPONENT32F
+};
+ShadowAtlas shadowAtlas;
+
+// 图集中的一个立方体面：左下角和边长（像素），size 为 0 表示没有分到空间
+struct ShadowAtlasRect
+{
+	int x = 0;
+	int y = 0;
+	int size = 0;
+};
+
+bool ensureShadowAtlas(bool depth16);
+int shadowFaceResolution(float importance, int current);
+void fitShadowBudget(const std::vector<float>& importance, const std::vector<int>& faceCounts, std::vector<int>& faceSizes);
+void packShadowAtlas(const std::vector<int>& faceSizes, const std::vector<int>& faceCounts, std::vector<ShadowAtlasRect>& rects);
+size_t shadowAtlasBytes();
+
+// 按需（重新）分配图集，格式改变时返回 true，此时所有阴影都要重画
+bool ensureShadowAtlas(bool depth16)
+{
+	if (shadowAtlas.fbo != 0 && shadowAtlas.depth16 == depth16) return false;
+
+	if (shadowAtlas.fbo == 0)
+	{
+		glGenFramebuffers(1, &shadowAtlas.fbo);
+		glGenTextures(1, &shadowAtlas.depthTexture);
+		glGenSamplers(1, &shadowAtlas.compareSampler);
+		glSamplerParameteri(shadowAtlas.compareSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glSamplerParameteri(shadowAtlas.compareSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glSamplerParameteri(shadowAtlas.compareSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glSamplerParameteri(shadowAtlas.compareSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glSamplerParameteri(shadowAtlas.compareSampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glSamplerParameteri(shadowAtlas.compareSampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	}
+	shadowAtlas.depth16 = depth16;
+
+	glBindTexture(GL_TEXTURE_2D, shadowAtlas.depthTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, depth16 ? GL_DEPTH_COMPONENT16 : GL_DEPTH_COMPONENT32F,
+		SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, 0, GL_DEPTH_COMPONENT, depth16 ? GL_UNSIGNED_SHORT : GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, shadowAtlas.fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowAtlas.depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER:: Shadow atlas FBO incomplete!" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	std::cout << "[Shadow] atlas " << SHADOW_ATLAS_SIZE << "x" << SHADOW_ATLAS_SIZE
+		<< (depth16 ? " DEPTH16, " : " DEPTH32F, ") << shadowAtlasBytes() / (1024 * 1024) << " MB" << std::endl;
+	return true;
+}
+
+size_t shadowAtlasBytes()
+{
+	return (size_t)SHADOW_ATLAS_SIZE * SHADOW_ATLAS_SIZE * (shadowAtlas.depth16 ? 2 : 4);
+}
+
+// importance 为期望分辨率占 SHADOW_FACE_MAX 的比例；current 为上一帧的请求值（预算裁剪之前），
+// 期望值只在相邻两档的边界附近时保持不变，避免相机来回移动时反复重画
+// 滞回按相邻一档算：升档要到 current * 2 的 90%，降档要低于 current 的 60%（四舍五入本来在 75% 处降档）
+int shadowFaceResolution(float importance, int current)
+{
+	float texels = SHADOW_FACE_MAX * importance;
+	int size = SHADOW_FACE_MIN;
+	while (size < SHADOW_FACE_MAX && size * 2 <= texels) size *= 2;
+
+	if (current > 0 && size > current && texels < current * 2 * 0.9f) return current;
+	if (current > 0 && size < current && texels >= current * 0.6f) return current;
+	return size;
+}
+
+// 总面积超出图集时逐档减半；都降到最低档仍放不下时，最不重要的光源不再投射阴影（边长置 0）
+// faceCounts 为各光源的面数：点光源 6，聚光灯 1
+void fitShadowBudget(const std::vector<float>& importance, const std::vector<int>& faceCounts, std::vector<int>& faceSizes)
+{
+	const size_t budget = (size_t)SHADOW_ATLAS_SIZE * SHADOW_ATLAS_SIZE;
+	auto used = [&]()
+		{
+			size_t area = 0;
+			for (size_t i = 0; i < faceSizes.size(); ++i) area += faceCounts[i] * (size_t)faceSizes[i] * faceSizes[i];
+			return area;
+		};
+
+	std::vector<size_t> order(faceSizes.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return importance[a] < importance[b]; });
+
+	while (used() > budget)
+	{
+		// 先降当前最大的一档，同档里先降最不重要的
+		size_t largest = order.size();
+		for (size_t i : order)
+		{
+			if (faceSizes[i] > SHADOW_FACE_MIN && (largest == order.size() || faceSizes[i] > faceSizes[largest]))
+				largest = i;
+		}
+		if (largest != order.size())
+		{
+			faceSizes[largest] /= 2;
+			continue;
+		}
+		for (size_t i : order)
+		{
+			if (faceSizes[i] > 0)
+			{
+				faceSizes[i] = 0;
+				break;
+			}
+		}
+	}
+}
+
+// 图集按 SHADOW_FACE_MIN 划分成网格，网格单元按 Morton（Z 序）编号
+static int shadowAtlasCompactBits(unsigned int v)
+{
+	v &= 0x55555555u;
+	v = (v | (v >> 1)) & 0x33333333u;
+	v = (v | (v >> 2)) & 0x0F0F0F0Fu;
+	v = (v | (v >> 4)) & 0x00FF00FFu;
+	v = (v | (v >> 8)) & 0x0000FFFFu;
+	return (int)v;
+}
+
+// 每个光源 faceCounts[i] 个面，边长都是 2 的幂：按边长从大到小依次占用 Z 序网格单元，
+// 每个面的起始单元天然按自身面积对齐，所以正好是一个方块，不会产生碎片
+// rects 按光源下标 * 6 + 面 排列，聚光灯只用第 0 个
+void packShadowAtlas(const std::vector<int>& faceSizes, const std::vector<int>& faceCounts, std::vector<ShadowAtlasRect>& rects)
+{
+	rects.assign(faceSizes.size() * 6, ShadowAtlasRect());
+
+	std::vector<size_t> order(faceSizes.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return faceSizes[a] > faceSizes[b]; });
+
+	unsigned int cell = 0;
+	for (size_t light : order)
+	{
+		int size = faceSizes[light];
+		if (size == 0) continue;
+		unsigned int cells = (unsigned int)(size / SHADOW_FACE_MIN) * (size / SHADOW_FACE_MIN);
+		for (int face = 0; face < faceCounts[light]; ++face)
+		{
+			ShadowAtlasRect& rect = rects[light * 6 + face];
+			rect.x = shadowAtlasCompactBits(cell) * SHADOW_FACE_MIN;
+			rect.y = shadowAtlasCompactBits(cell >> 1) * SHADOW_FACE_MIN;
+			rect.size = size;
+			cell += cells;
+		}
+	}
+}
+#endif
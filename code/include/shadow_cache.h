@@ -0,0 +1,43 @@
+#ifndef SHADOW_CACHE_H
+#define SHADOW_CACHE_H
+
+#include <glm/glm.hpp>
+
+#include "frustum.h"
+
+// 阴影缓存：每个点光源的 6 个立方体面各有一个脏标记
+// 静态物体的阴影深度一直缓存，只有新增/移动/删除的物体碰到的面才重新渲染
+const unsigned int SHADOW_ALL_FACES = 0x3F;
+
+// 物体上次参与阴影渲染时的状态，与场景物体按下标一一对应
+struct ShadowCasterRecord
+{
+	const void* model = nullptr;
+	glm::vec3 worldMin = glm::vec3(0.0f);
+	glm::vec3 worldMax = glm::vec3(0.0f);
+};
+
+// 世界空间包围盒在光源范围球内时，返回它接触到的立方体面掩码（bit i 对应第 i 面）
+// 只测前 faceCount 个面：聚光灯 1 个、四面体布局 4 个，其余 faceFrusta 没有更新
+inline unsigned int shadowFacesTouched(const glm::vec3& lightPos, float range, const Frustum faceFrusta[6], int faceCount,
+	const glm::vec3& worldMin, const glm::vec3& worldMax)
+{
+	glm::vec3 closest = glm::clamp(lightPos, worldMin, worldMax);
+	glm::vec3 d = closest - lightPos;
+	if (glm::dot(d, d) > range * range) return 0;
+
+	unsigned int mask = 0;
+	for (int face = 0; face < faceCount; ++face)
+	{
+		if (faceFrusta[face].intersectsAABB(worldMin, worldMax)) mask |= 1u << face;
+	}
+	return mask;
+}
+
+inline int shadowFaceCount(unsigned int mask)
+{
+	int count = 0;
+	for (; mask; mask &= mask - 1) ++count;
+	return count;
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef SHADOW_MASK_H
+#define SHADOW_MASK_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <shader.h>
+#include "render_graph.h"
+
+#include <functional>
+
+// 屏幕空间阴影遮罩（前向渲染 + 深度预通道时使用）：预通道之后按深度重建世界坐标，
+// 每个（低分辨率）像素只算一次点光源阴影，结果打包进 RGBA8，不透明通道直接读遮罩，
+// 阴影开销只与屏幕像素数有关，与过度绘制无关
+// 通道分配见 shadow_mask.fs：簇内第一个 shadowIndex & 3 == c 的阴影光源占用通道 c，其余光源仍在着色时自己算
+const int SHADOW_MASK_TEXTURE_UNIT = 8;
+const int SHADOW_MASK_DEPTH_TEXTURE_UNIT = 9;
+
+// 遮罩和深度副本都是渲染图的临时纹理
+struct ShadowMaskTargets
+{
+	RGHandle mask = RG_NONE;  // RGBA8，每个通道一个光源的遮挡比例
+	RGHandle depth = RG_NONE; // 预通道深度的副本：不透明通道要一边深度测试一边采样它，不能直接用场景深度
+	int scale = 1;            // 1: 全分辨率, 2: 半分辨率
+};
+
+ShadowMaskTargets addShadowMaskPasses(Shader& maskShader, const glm::mat4& viewProjection, RGHandle sceneDepth, int width, int height, int scale, std::function<void()> setupUniforms);
+void bindShadowMask(Shader& shader, const ShadowMaskTargets& targets);
+
+// 在深度预通道之后声明：复制场景深度，再全屏计算遮罩
+// setupUniforms 在遮罩通道里调用，设置点光源/平行光 uniform；分簇数据和阴影图集需已绑定
+ShadowMaskTargets addShadowMaskPasses(Shader& maskShader, const glm::mat4& viewProjection, RGHandle sceneDepth, int width, int height, int scale, std::function<void()> setupUniforms)
+{
+	ShadowMaskTargets targets;
+	targets.scale = scale;
+
+	RGTextureDesc depthDesc;
+	depthDesc.width = width;
+	depthDesc.height = height;
+	depthDesc.internalFormat = GL_DEPTH24_STENCIL8; // 与场景深度一致才能 blit
+	targets.depth = rgCreateTexture("shadow mask depth", depthDesc);
+
+	RGTextureDesc maskDesc;
+	maskDesc.width = (width + scale - 1) / scale;
+	maskDesc.height = (height + scale - 1) / scale;
+	maskDesc.internalFormat = GL_RGBA8;
+	targets.mask = rgCreateTexture("shadow mask", maskDesc);
+
+	RGHandle depthCopy = targets.depth;
+	rgAddPass("shadow mask depth", { sceneDepth }, {}, depthCopy, [=]() {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, rgFramebuffer({}, sceneDepth));
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	});
+
+	rgAddPass("shadow mask", { depthCopy }, { targets.mask }, RG_NONE, [=, &maskShader]() {
+		beginGpuTimer("shadowmask");
+		maskShader.use();
+		setupUniforms();
+		glDisable(GL_DEPTH_TEST);
+		maskShader.setMat4("invViewProjection", glm::inverse(viewProjection));
+		maskShader.setInt("sceneDepth", SHADOW_MASK_DEPTH_TEXTURE_UNIT);
+		maskShader.setInt("maskScale", scale);
+		maskShader.setVec2("screenSize", (float)width, (float)height);
+		glActiveTexture(GL_TEXTURE0 + SHADOW_MASK_DEPTH_TEXTURE_UNIT);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(depthCopy));
+		glActiveTexture(GL_TEXTURE0 + SHADOW_MASK_TEXTURE_UNIT);
+		glBindTexture(GL_TEXTURE_2D, 0); // 遮罩纹理正作为渲染目标，不能同时绑定在采样单元上
+		renderQuad();
+		glEnable(GL_DEPTH_TEST);
+		endGpuTimer();
+	});
+	return targets;
+}
+
+// 不透明通道开始时调用：绑定遮罩和深度副本并启用遮罩
+void bindShadowMask(Shader& shader, const ShadowMaskTargets& targets)
+{
+	glActiveTexture(GL_TEXTURE0 + SHADOW_MASK_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, rgTexture(targets.mask));
+	glActiveTexture(GL_TEXTURE0 + SHADOW_MASK_DEPTH_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, rgTexture(targets.depth));
+	shader.setInt("shadowMaskScale", targets.scale);
+	shader.setBool("useShadowMask", true);
+}
+#endif
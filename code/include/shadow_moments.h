@@ -0,0 +1,121 @@
+#ifndef SHADOW_MOMENTS_H
+#define SHADOW_MOMENTS_H
+
+#include <glad/glad.h>
+
+#include <shader.h>
+#include "shadow_atlas.h"
+
+#include <vector>
+#include <iostream>
+
+// 点光源矩阴影（方差阴影）：阴影面更新后，把深度降采样成 (d, d^2) 两阶矩、模糊并生成 mipmap，
+// 着色时每个光源只取一次过滤后的矩，用切比雪夫不等式估计遮挡概率
+// 矩图集与深度图集布局相同、分辨率减半，因此两者的归一化坐标一致
+const int SHADOW_MOMENT_DOWNSAMPLE = 2;
+const int SHADOW_MOMENT_SIZE = SHADOW_ATLAS_SIZE / SHADOW_MOMENT_DOWNSAMPLE;
+const int SHADOW_MOMENT_SCRATCH = SHADOW_FACE_MAX / SHADOW_MOMENT_DOWNSAMPLE;
+
+struct ShadowMoments
+{
+	unsigned int fbo = 0;
+	unsigned int texture = 0;           // RG32F，带 mipmap
+	unsigned int scratchFBO[2] = { 0, 0 };
+	unsigned int scratchTexture[2] = { 0, 0 }; // 单个面的中间结果（矩 -> 水平模糊）
+};
+ShadowMoments shadowMoments;
+
+void ensureShadowMoments();
+void filterShadowMoments(const std::vector<ShadowAtlasRect>& faces, Shader& momentShader, Shader& blurShader);
+
+static void attachShadowMomentTarget(unsigned int fbo, unsigned int texture)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER:: Shadow moment FBO incomplete!" << std::endl;
+	}
+}
+
+// 第一次使用矩阴影时才分配（RG32F：二阶矩用半精度会严重漏光）
+void ensureShadowMoments()
+{
+	if (shadowMoments.fbo != 0) return;
+
+	glGenFramebuffers(1, &shadowMoments.fbo);
+	glGenTextures(1, &shadowMoments.texture);
+	glBindTexture(GL_TEXTURE_2D, shadowMoments.texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, SHADOW_MOMENT_SIZE, SHADOW_MOMENT_SIZE, 0, GL_RG, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	attachShadowMomentTarget(shadowMoments.fbo, shadowMoments.texture);
+
+	glGenFramebuffers(2, shadowMoments.scratchFBO);
+	glGenTextures(2, shadowMoments.scratchTexture);
+	for (int i = 0; i < 2; ++i)
+	{
+		glBindTexture(GL_TEXTURE_2D, shadowMoments.scratchTexture[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, SHADOW_MOMENT_SCRATCH, SHADOW_MOMENT_SCRATCH, 0, GL_RG, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		attachShadowMomentTarget(shadowMoments.scratchFBO[i], shadowMoments.scratchTexture[i]);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	size_t bytes = (size_t)SHADOW_MOMENT_SIZE * SHADOW_MOMENT_SIZE * 8 * 4 / 3;
+	std::cout << "[Shadow] moment atlas " << SHADOW_MOMENT_SIZE << "x" << SHADOW_MOMENT_SIZE
+		<< " RG32F + mips, " << bytes / (1024 * 1024) << " MB" << std::endl;
+}
+
+// 对本帧重画过的阴影面生成矩：深度 -> 矩(scratch 0) -> 水平模糊(scratch 1) -> 垂直模糊(矩图集)，最后统一生成一次 mipmap
+void filterShadowMoments(const std::vector<ShadowAtlasRect>& faces, Shader& momentShader, Shader& blurShader)
+{
+	if (faces.empty()) return;
+	ensureShadowMoments();
+
+	glDisable(GL_DEPTH_TEST);
+	for (const ShadowAtlasRect& rect : faces)
+	{
+		int size = rect.size / SHADOW_MOMENT_DOWNSAMPLE;
+		int targetX = rect.x / SHADOW_MOMENT_DOWNSAMPLE;
+		int targetY = rect.y / SHADOW_MOMENT_DOWNSAMPLE;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, shadowMoments.scratchFBO[0]);
+		glViewport(0, 0, size, size);
+		momentShader.use();
+		momentShader.setInt("depthAtlas", 0);
+		glUniform2i(glGetUniformLocation(momentShader.ID, "sourceOrigin"), rect.x, rect.y);
+		glUniform2i(glGetUniformLocation(momentShader.ID, "targetOrigin"), 0, 0);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, shadowAtlas.depthTexture);
+		renderQuad();
+
+		blurShader.use();
+		blurShader.setInt("source", 0);
+		blurShader.setInt("size", size);
+		glUniform2i(glGetUniformLocation(blurShader.ID, "sourceOrigin"), 0, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, shadowMoments.scratchFBO[1]);
+		glUniform2i(glGetUniformLocation(blurShader.ID, "targetOrigin"), 0, 0);
+		glUniform2i(glGetUniformLocation(blurShader.ID, "direction"), 1, 0);
+		glBindTexture(GL_TEXTURE_2D, shadowMoments.scratchTexture[0]);
+		renderQuad();
+
+		glBindFramebuffer(GL_FRAMEBUFFER, shadowMoments.fbo);
+		glViewport(targetX, targetY, size, size);
+		glUniform2i(glGetUniformLocation(blurShader.ID, "targetOrigin"), targetX, targetY);
+		glUniform2i(glGetUniformLocation(blurShader.ID, "direction"), 0, 1);
+		glBindTexture(GL_TEXTURE_2D, shadowMoments.scratchTexture[1]);
+		renderQuad();
+	}
+	glEnable(GL_DEPTH_TEST);
+
+	glBindTexture(GL_TEXTURE_2D, shadowMoments.texture);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+#endif
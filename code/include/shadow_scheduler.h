@@ -0,0 +1,101 @@
+#ifndef SHADOW_SCHEDULER_H
+#define SHADOW_SCHEDULER_H
+
+#include <glm/glm.hpp>
+
+#include "gpu_timer.h"
+
+#include <vector>
+#include <algorithm>
+
+// 阴影更新调度：脏的立方体面不在同一帧全部重画，每帧按纹素预算挑选优先级最高的面，其余顺延到后面几帧
+// 优先级 = 屏幕重要性 x (1 + 已等待帧数)；内容无效的面（刚分到新的图集区域）排在最前，
+// 等待达到 SHADOW_MAX_STALE_FRAMES 的面不受预算限制必画，所以阴影最多滞后这么多帧
+const int SHADOW_MAX_STALE_FRAMES = 8;
+const double SHADOW_UPDATE_TARGET_MS = 1.5;                 // 阴影通道的 GPU 时间目标
+const size_t SHADOW_FACE_OVERHEAD_TEXELS = 128 * 128;       // 每个面的固定开销（剔除、清除、提交）折算成纹素
+const size_t SHADOW_BUDGET_MIN_TEXELS = 1024 * 1024;        // 至少能画一个满分辨率面，保证有进展
+const size_t SHADOW_BUDGET_MAX_TEXELS = 16 * 1024 * 1024;
+
+// 一个待更新的面
+struct ShadowFaceRequest
+{
+	size_t light;        // 光源下标
+	int face;
+	int size;            // 面边长
+	float importance;
+	int staleFrames;     // 变脏以来等待的帧数
+	bool valid;          // 图集区域里现有内容是否仍可用（过时但可显示）
+};
+
+// 每帧纹素预算，按阴影通道实测 GPU 时间自适应
+struct ShadowUpdateBudget
+{
+	size_t texels = 4 * 1024 * 1024;
+	double targetMs = SHADOW_UPDATE_TARGET_MS; // 画质调节器降级时会减小
+	double msPerTexel = 0.0;
+	size_t history[GpuTimer::LATENCY] = {}; // 与 GPU 计时的环形缓冲对齐：每次计时画了多少纹素
+	int next = 0;
+};
+ShadowUpdateBudget shadowUpdateBudget;
+
+inline size_t shadowFaceCost(int size)
+{
+	return (size_t)size * size + SHADOW_FACE_OVERHEAD_TEXELS;
+}
+
+std::vector<size_t> scheduleShadowFaces(const std::vector<ShadowFaceRequest>& requests, size_t& scheduledTexels);
+void updateShadowBudget(size_t renderedTexels);
+
+// 返回本帧要画的请求下标；scheduledTexels 为它们的总开销
+std::vector<size_t> scheduleShadowFaces(const std::vector<ShadowFaceRequest>& requests, size_t& scheduledTexels)
+{
+	std::vector<size_t> order(requests.size());
+	for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+	auto priority = [&](const ShadowFaceRequest& r)
+		{
+			return (r.importance + 0.01f) * (1.0f + r.staleFrames);
+		};
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			const ShadowFaceRequest& ra = requests[a];
+			const ShadowFaceRequest& rb = requests[b];
+			if (ra.valid != rb.valid) return !ra.valid;
+			return priority(ra) > priority(rb);
+		});
+
+	std::vector<size_t> selected;
+	scheduledTexels = 0;
+	for (size_t i : order)
+	{
+		const ShadowFaceRequest& r = requests[i];
+		size_t cost = shadowFaceCost(r.size);
+		bool forced = r.staleFrames >= SHADOW_MAX_STALE_FRAMES;
+		// 第一个面总是画，避免单个面超出预算时永远排不上
+		if (!forced && !selected.empty() && scheduledTexels + cost > shadowUpdateBudget.texels) continue;
+		selected.push_back(i);
+		scheduledTexels += cost;
+	}
+	return selected;
+}
+
+// 在 beginGpuTimer("shadow") 之后调用：收回 LATENCY 次之前的耗时，与当时画的纹素数配对，更新单位纹素耗时和预算
+void updateShadowBudget(size_t renderedTexels)
+{
+	ShadowUpdateBudget& budget = shadowUpdateBudget;
+	double ms = 0.0;
+	size_t measured = budget.history[budget.next];
+	if (takeGpuTimerResult("shadow", ms) && measured > 0)
+	{
+		double sample = ms / measured;
+		budget.msPerTexel = budget.msPerTexel == 0.0 ? sample : glm::mix(budget.msPerTexel, sample, 0.2);
+		if (budget.msPerTexel > 0.0)
+		{
+			double texels = budget.targetMs / budget.msPerTexel;
+			budget.texels = (size_t)glm::clamp(texels, (double)SHADOW_BUDGET_MIN_TEXELS, (double)SHADOW_BUDGET_MAX_TEXELS);
+		}
+	}
+	budget.history[budget.next] = renderedTexels;
+	budget.next = (budget.next + 1) % GpuTimer::LATENCY;
+}
+#endif
@@ -9,6 +9,7 @@
 #include<vector>
 #include<iostream>
 #include<string>
+#include<algorithm>
 
 // 天空盒相关
 unsigned int captureFBO;
@@ -30,6 +31,7 @@ void initSkyboxFrameBuffer();
 unsigned int loadCubemap(const char* filename, Shader& equirectangularToCubemapShader);
 unsigned int createIrradianceMap(unsigned int cubemap, Shader& irradianceShader);
 unsigned int createPrefilterMap(unsigned int cubemap, Shader& prefilterShader);
+void prefilterCubemapMip(Shader& prefilterShader, unsigned int sourceCubemap, unsigned int sourceResolution, unsigned int targetCubemap, unsigned int targetSize, unsigned int mip, unsigned int maxMipLevels);
 unsigned int createBRDFLUT(Shader& brdfShader);
 
 void initSkyboxFrameBuffer()
@@ -175,37 +177,45 @@ unsigned int createPrefilterMap(unsigned int envCubemap, Shader& prefilterShader
 
     // pbr: run a quasi monte-carlo simulation on the environment lighting to create a prefilter (cube)map.
     // ----------------------------------------------------------------------------------------------------
+    unsigned int maxMipLevels = 5;
+    for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
+    {
+        prefilterCubemapMip(prefilterShader, envCubemap, 512, prefilterMap, 256, mip, maxMipLevels);
+    }
+
+    return prefilterMap;
+}
+
+// 预滤波一级 mip 的 6 个面：粗糙度 = mip / (maxMipLevels - 1)，sourceResolution 为源立方体贴图的边长（决定采样哪级 mip）
+// 反射探针按帧分摊时每帧只调用一次
+void prefilterCubemapMip(Shader& prefilterShader, unsigned int sourceCubemap, unsigned int sourceResolution, unsigned int targetCubemap, unsigned int targetSize, unsigned int mip, unsigned int maxMipLevels)
+{
     prefilterShader.use();
     prefilterShader.setInt("environmentMap", 0);
     prefilterShader.setMat4("projection", captureProjection);
+    prefilterShader.setFloat("sourceResolution", (float)sourceResolution);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, sourceCubemap);
 
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    unsigned int maxMipLevels = 5;
-    for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
+    // reisze framebuffer according to mip-level size.
+    unsigned int mipWidth = std::max(1u, targetSize >> mip);
+    unsigned int mipHeight = std::max(1u, targetSize >> mip);
+    glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
+    glViewport(0, 0, mipWidth, mipHeight);
+
+    float roughness = (float)mip / (float)(maxMipLevels - 1);
+    prefilterShader.setFloat("roughness", roughness);
+    for (unsigned int i = 0; i < 6; ++i)
     {
-        // reisze framebuffer according to mip-level size.
-        unsigned int mipWidth = static_cast<unsigned int>(256 * std::pow(0.5, mip));
-        unsigned int mipHeight = static_cast<unsigned int>(256 * std::pow(0.5, mip));
-        glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-        glViewport(0, 0, mipWidth, mipHeight);
-
-        float roughness = (float)mip / (float)(maxMipLevels - 1);
-        prefilterShader.setFloat("roughness", roughness);
-        for (unsigned int i = 0; i < 6; ++i)
-        {
-            prefilterShader.setMat4("view", captureViews[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilterMap, mip);
-
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            renderCube();
-        }
+        prefilterShader.setMat4("view", captureViews[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, targetCubemap, mip);
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        renderCube();
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    return prefilterMap;
 }
 
 // 生成BRDF查找表（256x256）
@@ -0,0 +1,165 @@
+#ifndef TAA_H
+#define TAA_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <shader.h>
+#include "render_graph.h"
+#include "quality_governor.h"
+
+#include <string>
+
+// 时间抗锯齿（TAA）：投影矩阵每帧做亚像素抖动，运动向量通道由深度重建每个像素上一帧的位置，
+// 解析通道把当前帧混进重投影后的历史，历史先按当前帧 3x3 邻域的颜色范围裁剪，减轻拖影
+// 运动向量目前只含相机运动（场景物体都是静止的），物体自身的运动以后可以直接写进同一张速度纹理
+// 多帧累积会抹平逐帧变化的采样噪声，开启时 PCF 和视差步数用低档
+const int TAA_SAMPLE_COUNT = 8;         // Halton(2, 3) 抖动序列长度
+const float TAA_HISTORY_BLEND = 0.1f;   // 当前帧权重
+const int TAA_PCF_TAPS = PCF_TAPS_LOW;
+const int TAA_POM_MAX_STEPS = POM_MAX_STEPS_LOW;
+
+struct TemporalAA
+{
+	// 两张历史交替读写：current 为最近一次解析结果
+	unsigned int history[2] = { 0, 0 }; // RGBA16F，线性过滤（重投影取样和放大都用双线性）
+	int width = 0;
+	int height = 0;
+	int current = 0;
+	bool historyValid = false;
+	unsigned int frameIndex = 0;
+	glm::mat4 prevViewProjection = glm::mat4(1.0f); // 上一帧未抖动的 VP
+};
+TemporalAA temporalAA;
+
+glm::vec2 temporalJitter();
+glm::mat4 jitterProjection(const glm::mat4& projection, int width, int height);
+float temporalNoiseOffset();
+void resetTemporalAA();
+RGHandle addTemporalAAPasses(Shader& velocityShader, Shader& taaShader, const glm::mat4& viewProjection, const glm::mat4& unjitteredViewProjection, RGHandle sceneColor, RGHandle sceneDepth, int width, int height);
+
+static float halton(unsigned int index, unsigned int base)
+{
+	float result = 0.0f;
+	float f = 1.0f;
+	while (index > 0)
+	{
+		f /= (float)base;
+		result += f * (float)(index % base);
+		index /= base;
+	}
+	return result;
+}
+
+// 本帧的亚像素抖动，单位为像素，范围 [-0.5, 0.5)
+glm::vec2 temporalJitter()
+{
+	unsigned int index = temporalAA.frameIndex % TAA_SAMPLE_COUNT + 1; // 跳过 0，序列第 0 项是 (0, 0)
+	return glm::vec2(halton(index, 2), halton(index, 3)) - 0.5f;
+}
+
+// 平移裁剪空间 xy：jitter 像素 = 2 * jitter / 尺寸 的 NDC 偏移，透视矩阵第 3 列乘 w（= -z）后正好整体平移
+glm::mat4 jitterProjection(const glm::mat4& projection, int width, int height)
+{
+	glm::vec2 jitter = temporalJitter();
+	glm::mat4 result = projection;
+	result[2][0] += 2.0f * jitter.x / (float)width;
+	result[2][1] += 2.0f * jitter.y / (float)height;
+	return result;
+}
+
+// 逐帧变化的噪声偏移（黄金比例序列），加到 PCF 旋转角上，由累积把噪声抹平
+float temporalNoiseOffset()
+{
+	return glm::fract(temporalAA.frameIndex * 0.618034f);
+}
+
+// 开关 TAA 或画面突变时丢弃历史
+void resetTemporalAA()
+{
+	temporalAA.historyValid = false;
+}
+
+// 按渲染分辨率（重新）分配两张历史；尺寸变化后旧历史作废
+static void ensureTemporalAA(int width, int height)
+{
+	if (temporalAA.history[0] != 0 && temporalAA.width == width && temporalAA.height == height) return;
+
+	if (temporalAA.history[0] == 0) glGenTextures(2, temporalAA.history);
+	temporalAA.width = width;
+	temporalAA.height = height;
+	temporalAA.historyValid = false;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		glBindTexture(GL_TEXTURE_2D, temporalAA.history[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+}
+
+// 场景通道之后声明：viewProjection 为本帧抖动后的 VP（与深度一致），unjitteredViewProjection 用于算运动向量
+// 运动向量是临时纹理，两张历史由这里管理并导入渲染图；返回本帧解析结果（线性 HDR）
+RGHandle addTemporalAAPasses(Shader& velocityShader, Shader& taaShader, const glm::mat4& viewProjection, const glm::mat4& unjitteredViewProjection, RGHandle sceneColor, RGHandle sceneDepth, int width, int height)
+{
+	ensureTemporalAA(width, height);
+	int current = temporalAA.current;
+	int next = 1 - current;
+	bool historyValid = temporalAA.historyValid;
+	glm::mat4 prevViewProjection = historyValid ? temporalAA.prevViewProjection : unjitteredViewProjection;
+
+	RGTextureDesc velocityDesc;
+	velocityDesc.width = width;
+	velocityDesc.height = height;
+	velocityDesc.internalFormat = GL_RG16F; // 当前 uv - 上一帧 uv（不含抖动）
+	RGHandle velocity = rgCreateTexture("velocity", velocityDesc);
+	RGHandle history = rgImportTexture("taa history " + std::to_string(current), temporalAA.history[current], width, height, GL_RGBA16F);
+	RGHandle output = rgImportTexture("taa history " + std::to_string(next), temporalAA.history[next], width, height, GL_RGBA16F);
+
+	// 运动向量：由深度重建世界坐标，分别投影到本帧和上一帧
+	rgAddPass("velocity", { sceneDepth }, { velocity }, RG_NONE, [=, &velocityShader]() {
+		beginGpuTimer("taa");
+		glDisable(GL_DEPTH_TEST);
+		velocityShader.use();
+		velocityShader.setMat4("invViewProjection", glm::inverse(viewProjection));
+		velocityShader.setMat4("currViewProjection", unjitteredViewProjection);
+		velocityShader.setMat4("prevViewProjection", prevViewProjection);
+		velocityShader.setInt("sceneDepth", 0);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(sceneDepth));
+		renderQuad();
+	});
+
+	// 解析：读上一次的历史，写进另一张
+	rgAddPass("taa resolve", { sceneColor, history, velocity, sceneDepth }, { output }, RG_NONE, [=, &taaShader]() {
+		taaShader.use();
+		taaShader.setInt("currentColor", 0);
+		taaShader.setInt("historyColor", 1);
+		taaShader.setInt("velocityTexture", 2);
+		taaShader.setInt("sceneDepth", 3);
+		taaShader.setBool("historyValid", historyValid);
+		taaShader.setFloat("historyBlend", TAA_HISTORY_BLEND);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(sceneColor));
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(history));
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(velocity));
+		glActiveTexture(GL_TEXTURE3);
+		glBindTexture(GL_TEXTURE_2D, rgTexture(sceneDepth));
+		renderQuad();
+		glEnable(GL_DEPTH_TEST);
+		endGpuTimer();
+
+		temporalAA.current = next;
+		temporalAA.historyValid = true;
+		temporalAA.prevViewProjection = unjitteredViewProjection;
+		temporalAA.frameIndex++;
+	});
+	return output;
+}
+#endif
@@ -11,9 +11,30 @@
 #include <model.h>
 #include "SceneRender.h"
 #include "skybox.h"
+#include "impostor.h"
+#include "frustum.h"
+#include "oit.h"
+#include "gpu_timer.h"
+#include "gbuffer.h"
+#include "clustered_lights.h"
+#include "shadow_cache.h"
+#include "shadow_atlas.h"
+#include "shadow_moments.h"
+#include "csm.h"
+#include "shadow_scheduler.h"
+#include "shadow_mask.h"
+#include "cone_map.h"
+#include "scene_target.h"
+#include "quality_governor.h"
+#include "taa.h"
+#include "post_process.h"
+#include "light_probes.h"
+#include "lightmap.h"
+#include "reflection_probes.h"
 
 #include <iostream>
 #include <functional>
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -61,22 +82,25 @@ struct Object
 		return model;
 	}
 
-	// 正常渲染
-	void Draw(Shader& shader)
+	// 上传变换矩阵和 IBL 开关
+	void setUniforms(Shader& shader) const
 	{
-		if (useIBL)
-		{
-			shader.setBool("useIBL", true);
-		}
+		shader.setBool("useIBL", useIBL);
 		glm::mat4 modelMatrix = getModelMatrix();
 		shader.setMat4("model", modelMatrix);
 		shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(modelMatrix))));
-		modelData->Draw(shader);
+	}
+
+	// 正常渲染（只画不透明网格，透明网格交给透明通道）
+	void Draw(Shader& shader)
+	{
+		setUniforms(shader);
+		modelData->DrawOpaque(shader);
 		shader.setBool("useIBL", false);
 	}
 
 	// 深度/阴影渲染
-	void DrawDepth(Shader& shader)
+	void DrawDepth(Shader& shader, bool useProxy)
 	{
 		//if (modelData == getModelResource("model/ceiling_light/scene.gltf", true))
 		//{
@@ -84,15 +108,32 @@ struct Object
 		//}
 		glm::mat4 modelMatrix = getModelMatrix();
 		shader.setMat4("model", modelMatrix);
-		// 使用深度模式绘制
-		// 这里的 true 表示开启深度绘制优化（不绑定材质）
-		modelData->Draw(shader, true);
+		// 只提交去重后的位置流（不绑定材质），有简化代理网格时用代理
+		modelData->DrawShadow(useProxy);
+	}
+
+	// 深度预通道：只提交不透明网格的位置流
+	void DrawPrepass(Shader& shader)
+	{
+		shader.setMat4("model", getModelMatrix());
+		modelData->DrawOpaquePositions();
 	}
 };
 
 // 场景中的所有物体列表
 std::vector<Object> sceneObjects;
 
+// 透明通道中的一次绘制，按视深从远到近排序
+struct TransparentDraw
+{
+	Object* object;
+	Mesh* mesh;
+	float viewDepth;
+};
+
+// 远景替身：Key是模型资源，Value是烘焙好的替身图集
+std::map<Model*, Impostor*> impostorCache;
+
 // ==========================================
 // 控制参数与回调声明
 const float TRANS_SPEED = 5.0f;    // 平移速度
@@ -169,15 +210,57 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
 unsigned int loadTexture(const char* path);
+bool keyPressedOnce(GLFWwindow* window, int key);
 void initPointLights();
-void renderAllObjectsToDepth(Shader& depthShader);
+void updatePointLightShadowMatrices(struct PointLight& light);
+void setPointLightUniforms(Shader& shader);
+void renderAllObjectsToDepth(Shader& depthFaceShader, std::vector<ShadowAtlasRect>& updatedFaces);
+void updateShadowCache();
+void updateShadowAtlas(const Frustum& frustum);
+size_t scheduleShadowUpdates();
+void renderCascadedShadows(Shader& depthShader);
+void setDirLightUniforms(Shader& shader);
+void initBakedLighting(unsigned int skyIrradiance, unsigned int groundAlbedo, unsigned int floorAlbedo, unsigned int wallAlbedo, unsigned int ceilingAlbedo, bool bake);
 
 // settings
 unsigned int SCR_WIDTH = 1280;
 unsigned int SCR_HEIGHT = 720;
-const unsigned int SHADOW_WIDTH = 1024;
-const unsigned int SHADOW_HEIGHT = 1024;
-const unsigned int MAX_POINT_LIGHTS = 4;
+// 场景渲染分辨率 = 窗口 x qualityGovernor.renderScale，每帧更新
+int renderWidth = SCR_WIDTH;
+int renderHeight = SCR_HEIGHT;
+const unsigned int MAX_SHADOWED_POINT_LIGHTS = 32; // 与 pbr_lighting.glsl 一致，其余光源不投射阴影
+const float SPOT_MIN_CUTOFF = 0.26f; // cos(75°)：锥更宽时一张透视阴影图分辨率太低，按全向点光源处理
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 100.0f;
+bool useImpostors = true; // F1 切换远景替身
+bool useWeightedOIT = false; // F2 切换透明方式：排序混合 / 加权混合 OIT
+bool useDepthPrepass = true; // F3 切换深度预通道
+bool useDeferred = false; // F4 切换前向 / 延迟渲染
+bool useShadowDepth16 = false; // F5 切换阴影图集深度格式：32 位浮点 / 16 位
+bool useShadowProxies = false; // F6 切换阴影投射用简化代理网格 / 原始网格；代理误差超过阴影偏移，默认关闭
+// 点光源阴影过滤方式，与 pbr_lighting.glsl 一致
+const int SHADOW_FILTER_POINT = 0;   // 20 次逐点采样
+const int SHADOW_FILTER_PCF = 1;     // 硬件比较 + 旋转泊松盘，4~8 次
+const int SHADOW_FILTER_MOMENTS = 2; // 矩阴影，生成时模糊，着色时 1 次
+int shadowFilterMode = SHADOW_FILTER_PCF; // F7 循环切换
+bool useSunLight = true; // F8 切换平行光（太阳，级联阴影）
+bool readingLampShadows = false; // F9 切换阅读灯是否也投射阴影（阴影光源 4 -> 16，压力测试）
+// 点光源阴影布局，与 pbr_lighting.glsl 一致
+const int POINT_SHADOW_CUBE = 0;        // 6 个 90° 面
+const int POINT_SHADOW_TETRAHEDRAL = 1; // 4 个约 136°x126° 的面：投射者少画 1/3，同边长下纹素线密度只有立方体的 0.4~0.46 倍
+int pointShadowLayout = POINT_SHADOW_CUBE; // F10 切换
+// 屏幕空间阴影遮罩，仅前向渲染 + 深度预通道时生效
+const int SHADOW_MASK_OFF = 0;
+const int SHADOW_MASK_FULL = 1;
+const int SHADOW_MASK_HALF = 2; // 半分辨率 + 深度感知上采样
+int shadowMaskMode = SHADOW_MASK_FULL; // F11 循环切换
+bool useTAA = true; // T 切换时间抗锯齿（关闭时无抗锯齿）
+// 辐照度探针网格覆盖的图书馆内部（墙内侧、地板到天花板），L 切换探针 / 原来的环境光
+const glm::vec3 LIBRARY_BOUNDS_MIN(-22.0f, 0.5f, -21.5f);
+const glm::vec3 LIBRARY_BOUNDS_MAX(26.5f, 14.5f, 27.0f);
+const char* LIGHT_PROBE_PATH = "../code/assets/light_probes.bin";
+// 地板/墙/天花板图块的光照贴图，I 切换光照贴图 / 实时点光源 + 探针
+const char* LIGHTMAP_PATH = "../code/assets/lightmap.bin";
 
 // camera
 Camera camera(glm::vec3(0.0f, 2.5f, 3.0f));
@@ -191,26 +274,57 @@ struct PointLight
 	glm::vec3 position;
 	glm::vec3 color;
 	glm::vec3 direction;
-	float cutOff;
+	float cutOff; // 聚光锥半角余弦，锥不宽于 75° 时按聚光灯处理
 	float far_plane;
-	unsigned int depthCubemap;
-	unsigned int depthFBO;
+	bool castShadows = true;
+	int shadowIndex = -1; // 阴影槽位（shadowAtlasRects[shadowIndex * 6 + 面]），-1 表示无阴影
+	int shadowResolution = 0; // 当前在阴影图集中分到的面边长，0 表示本帧没有阴影
+	int requestedResolution = 0; // 按重要性请求的面边长（图集预算裁剪之前），作为下一帧分档滞回的依据
+	ShadowAtlasRect atlasRects[6];
 	glm::mat4 shadowMatrices[6];
+	Frustum faceFrusta[6];
+	unsigned int dirtyFaces = SHADOW_ALL_FACES; // 需要重新渲染的立方体面
+	unsigned int validFaces = 0; // 图集区域中内容可用（可能过时）的面，其余面着色时不采样
+	unsigned int scheduledFaces = 0; // 本帧调度器选中要画的面
+	int staleFrames[6] = {}; // 各面变脏以来等待的帧数
+	float importance = 0.0f; // 本帧的阴影重要性，调度器用
+	glm::vec3 shadowOrigin = glm::vec3(0.0f); // 阴影矩阵对应的光源位置和方向，光源移动/转向后重建
+	glm::vec3 shadowDirection = glm::vec3(0.0f);
+
+	// 聚光灯只有一张透视阴影图（第 0 面），点光源 6 个立方体面或 4 个四面体面
+	bool isSpot() const { return cutOff > SPOT_MIN_CUTOFF; }
+	int shadowFaceTotal() const { return isSpot() ? 1 : (pointShadowLayout == POINT_SHADOW_TETRAHEDRAL ? 4 : 6); }
+	unsigned int shadowFaceMask() const { return (1u << shadowFaceTotal()) - 1u; }
 };
 std::vector<PointLight> pointLights;
+size_t readingLampFirst = 0; // pointLights 中阅读灯的起始下标
+std::vector<ShadowCasterRecord> shadowCasterRecords; // 与 sceneObjects 按下标对应
+int shadowFacesRendered = 0; // 统计：上次打印以来重新渲染的立方体面数
+int shadowCasterFaceDraws = 0; // 统计：投射者被光栅化到的面数之和
+int shadowCasterCount = 0; // 统计：在光源范围内、参与阴影渲染的投射者数
+int shadowFacesDeferred = 0; // 统计：因超出预算顺延到下一帧的面数（按帧累加）
+int shadowStaleMax = 0; // 统计：脏面最长等待的帧数
+
+// 太阳：从 +z 一侧斜射，穿过 glass_window 照进室内
+const glm::vec3 SUN_DIRECTION = glm::normalize(glm::vec3(0.3f, -0.6f, -1.0f));
+const glm::vec3 SUN_COLOR = glm::vec3(3.0f, 2.85f, 2.6f);
+int cascadeCasterCounts[CSM_CASCADES] = {}; // 统计：上一帧每级画了多少个投射者
 
 // timing
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
 
-int main()
+int main(int argc, char** argv)
 {
+	// --bake：加载场景后烘焙探针和光照贴图写入缓存，然后退出；正常启动只读缓存
+	bool bakeOnly = argc > 1 && std::string(argv[1]) == "--bake";
+
 	// glfw: initialize and configure
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_SAMPLES, 4);
+	glfwWindowHint(GLFW_SAMPLES, 0); // 抗锯齿由 TAA 在渲染分辨率上完成（taa.h），窗口只接收最终结果
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
@@ -239,12 +353,27 @@ int main()
 
 	// 加载着色器
 	Shader pbrShader("../code/assets/shader/pbr.vs", "../code/assets/shader/pbr.fs");
-	Shader depthShader("../code/assets/shader/depth.vs", "../code/assets/shader/depth.fs", "../code/assets/shader/depth.gs");
+	Shader depthFaceShader("../code/assets/shader/depth_face.vs", "../code/assets/shader/depth.fs");
 	Shader equirectangularToCubemapShader("../code/assets/shader/cubemap.vs", "../code/assets/shader/equirectangular_to_cubemap.fs");
 	Shader irradianceShader("../code/assets/shader/cubemap.vs", "../code/assets/shader/irradiance.fs");
 	Shader prefilterShader("../code/assets/shader/cubemap.vs", "../code/assets/shader/prefilter.fs");
 	Shader brdfShader("../code/assets/shader/brdf.vs", "../code/assets/shader/brdf.fs");
 	Shader skyboxShader("../code/assets/shader/skybox.vs", "../code/assets/shader/skybox.fs");
+	Shader impostorBakeShader("../code/assets/shader/impostor_bake.vs", "../code/assets/shader/impostor_bake.fs");
+	Shader impostorShader("../code/assets/shader/impostor.vs", "../code/assets/shader/impostor.fs");
+	Shader depthPrepassShader("../code/assets/shader/depth_prepass.vs", "../code/assets/shader/depth_prepass.fs");
+	Shader oitCompositeShader("../code/assets/shader/quad.vs", "../code/assets/shader/oit_composite.fs");
+	Shader shadowMomentShader("../code/assets/shader/quad.vs", "../code/assets/shader/shadow_moments.fs");
+	Shader shadowBlurShader("../code/assets/shader/quad.vs", "../code/assets/shader/shadow_blur.fs");
+	Shader gbufferShader("../code/assets/shader/pbr.vs", "../code/assets/shader/gbuffer.fs");
+	Shader deferredLightingShader("../code/assets/shader/quad.vs", "../code/assets/shader/deferred_lighting.fs");
+	Shader shadowMaskShader("../code/assets/shader/quad.vs", "../code/assets/shader/shadow_mask.fs");
+	Shader postShader("../code/assets/shader/quad.vs", "../code/assets/shader/post.fs");
+	Shader bloomDownsampleShader("../code/assets/shader/quad.vs", "../code/assets/shader/bloom_downsample.fs");
+	Shader bloomUpsampleShader("../code/assets/shader/quad.vs", "../code/assets/shader/bloom_upsample.fs");
+	Shader velocityShader("../code/assets/shader/quad.vs", "../code/assets/shader/velocity.fs");
+	Shader taaShader("../code/assets/shader/quad.vs", "../code/assets/shader/taa.fs");
+	Shader reflectionCaptureShader("../code/assets/shader/pbr.vs", "../code/assets/shader/reflection_capture.fs");
 
 
 	// 着色器参数设置
@@ -263,6 +392,48 @@ int main()
 	skyboxShader.use();
 	skyboxShader.setInt("environmentMap", 0);
 
+	impostorShader.use();
+	impostorShader.setInt("albedoAtlas", 3);
+	impostorShader.setInt("normalAtlas", 4);
+	impostorShader.setInt("depthAtlas", 5);
+
+	oitCompositeShader.use();
+	oitCompositeShader.setInt("accumTexture", 0);
+	oitCompositeShader.setInt("weightTexture", 1);
+
+	gbufferShader.use();
+	gbufferShader.setInt("albedoMap", 3);
+	gbufferShader.setInt("normalMap", 4);
+	gbufferShader.setInt("metallicMap", 5);
+	gbufferShader.setInt("heightMap", 5);
+	gbufferShader.setInt("metallic_roughnessMap", 5);
+	gbufferShader.setInt("roughnessMap", 6);
+	gbufferShader.setInt("aoMap", 7);
+
+	deferredLightingShader.use();
+	deferredLightingShader.setInt("irradianceMap", 0);
+	deferredLightingShader.setInt("prefilterMap", 1);
+	deferredLightingShader.setInt("brdfLUT", 2);
+	deferredLightingShader.setInt("gAlbedo", 3);
+	deferredLightingShader.setInt("gNormal", 4);
+	deferredLightingShader.setInt("gMaterial", 5);
+	deferredLightingShader.setInt("gEmissive", 6);
+	deferredLightingShader.setInt("gDepth", 7);
+
+	shadowMaskShader.use();
+	shadowMaskShader.setInt("irradianceMap", 0);
+	shadowMaskShader.setInt("prefilterMap", 1);
+	shadowMaskShader.setInt("brdfLUT", 2);
+
+	reflectionCaptureShader.use();
+	reflectionCaptureShader.setInt("albedoMap", 3);
+	reflectionCaptureShader.setInt("normalMap", 4);
+	reflectionCaptureShader.setInt("metallicMap", 5);
+	reflectionCaptureShader.setInt("heightMap", 5);
+	reflectionCaptureShader.setInt("metallic_roughnessMap", 5);
+	reflectionCaptureShader.setInt("roughnessMap", 6);
+	reflectionCaptureShader.setInt("aoMap", 7);
+
 	// IBL 设定与生成
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -274,10 +445,22 @@ int main()
 	unsigned int brdfLUTTexture = createBRDFLUT(brdfShader);
 
 	// Lights
-	pointLights.push_back({ glm::vec3(-10.0f,14.125f, -10.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(90.0f)),50.0f });
-	pointLights.push_back({ glm::vec3(20.0f, 14.125f, -10.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(90.0f)),50.0f });
-	pointLights.push_back({ glm::vec3(20.0f, 14.125f, 15.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(90.0f)),50.0f });
-	pointLights.push_back({ glm::vec3(-10.0f, 14.125f, 15.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(90.0f)),50.0f });
+	// 吸顶灯只向下照：65° 半角的聚光灯，阴影只需一张透视图
+	pointLights.push_back({ glm::vec3(-10.0f,14.125f, -10.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(65.0f)),50.0f });
+	pointLights.push_back({ glm::vec3(20.0f, 14.125f, -10.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(65.0f)),50.0f });
+	pointLights.push_back({ glm::vec3(20.0f, 14.125f, 15.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(65.0f)),50.0f });
+	pointLights.push_back({ glm::vec3(-10.0f, 14.125f, 15.0f), glm::vec3(500.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(65.0f)),50.0f });
+	// 阅读灯：桌面和书架前的小范围暖光，默认不投射阴影，只参与分簇光照
+	readingLampFirst = pointLights.size();
+	const glm::vec3 readingLampPositions[] = {
+		glm::vec3(14.0f, 5.0f, -11.0f), glm::vec3(-6.0f, 5.0f, 9.0f), glm::vec3(-6.0f, 5.0f, -1.0f), glm::vec3(-6.0f, 5.0f, -11.0f),
+		glm::vec3(14.87f, 5.0f, 10.48f), glm::vec3(15.27f, 6.0f, -13.0f), glm::vec3(0.27f, 6.0f, -13.0f), glm::vec3(24.0f, 6.0f, -9.0f),
+		glm::vec3(21.0f, 6.0f, 4.48f), glm::vec3(21.0f, 6.0f, 17.48f), glm::vec3(7.0f, 6.0f, 10.48f), glm::vec3(13.0f, 6.0f, 24.0f),
+	};
+	for (const glm::vec3& lampPosition : readingLampPositions)
+	{
+		pointLights.push_back({ lampPosition, glm::vec3(1.0f, 0.85f, 0.6f) * 12.0f, glm::vec3(0.0f, -1.0f, 0.0f), glm::cos(glm::radians(90.0f)), 8.0f, false });
+	}
 	initPointLights();
 
 	// =============================================================
@@ -412,52 +595,63 @@ int main()
 
 	sceneObjects.emplace_back(resWindow, glm::vec3(19.99f, 4.38f, 27.48f), glm::vec3(0.0f), glm::vec3(0.86f, 2.63f, 2.73f), true);
 	sceneObjects.emplace_back(resWindow, glm::vec3(0.009f, 4.35f, 27.48f), glm::vec3(0.0f), glm::vec3(0.87f, 2.63f, 3.93f), true);
+
+	// 3. 为书架和成堆的书烘焙远景替身
+	for (Model* res : { resBooks1, resBooks2, resBookShelf, resBookShelf2, resBookcase1, resBookcase2, resbookshelf3 })
+	{
+		impostorCache[res] = bakeImpostor(*res, impostorBakeShader);
+	}
 	// --------------------------
 	// 纹理加载
 
 	unsigned int floorAlbedo = loadTexture("../code/assets/texture/floor/basecolor.png");
 	unsigned int floorNormal = loadTexture("../code/assets/texture/floor/normal.png");
-	unsigned int floorheight = loadTexture("../code/assets/texture/floor/height.png");
+	unsigned int floorheight = loadConeMap("../code/assets/texture/floor/height.png");
 	unsigned int floorRoughness = loadTexture("../code/assets/texture/floor/roughness.png");
 	unsigned int floorAO = loadTexture("../code/assets/texture/floor/ao.png");
 
 	unsigned int marblealbedo = loadTexture("../code/assets/texture/marble/basecolor.png");
 	unsigned int marblenormal = loadTexture("../code/assets/texture/marble/normal.png");
-	unsigned int marbleheight = loadTexture("../code/assets/texture/marble/height.png");
+	unsigned int marbleheight = loadConeMap("../code/assets/texture/marble/height.png");
 	unsigned int marbleroughness = loadTexture("../code/assets/texture/marble/roughness.png");
 
 	unsigned int wallalbedo = loadTexture("../code/assets/texture/wall/basecolor.png");
 	unsigned int wallnormal = loadTexture("../code/assets/texture/wall/normal.png");
-	unsigned int wallheight = loadTexture("../code/assets/texture/wall/height.png");
+	unsigned int wallheight = loadConeMap("../code/assets/texture/wall/height.png");
 	unsigned int wallroughness = loadTexture("../code/assets/texture/wall/roughness.png");
 	unsigned int wallao = loadTexture("../code/assets/texture/wall/ao.png");
 
 	unsigned int ceilingalbedo = loadTexture("../code/assets/texture/ceiling/basecolor.jpg");
 	unsigned int ceilingnormal = loadTexture("../code/assets/texture/ceiling/normal.jpg");
-	unsigned int ceilingheight = loadTexture("../code/assets/texture/ceiling/height.png");
+	unsigned int ceilingheight = loadConeMap("../code/assets/texture/ceiling/height.png");
 	unsigned int ceilingroughness = loadTexture("../code/assets/texture/ceiling/roughness.jpg");
 	unsigned int ceilingao = loadTexture("../code/assets/texture/ceiling/ao.jpg");
 
 	unsigned int tilesalbedo = loadTexture("../code/assets/texture/tiles/basecolor.jpg");
 	unsigned int tilesnormal = loadTexture("../code/assets/texture/tiles/normal.jpg");
-	unsigned int tilesheight = loadTexture("../code/assets/texture/tiles/height.png");
+	unsigned int tilesheight = loadConeMap("../code/assets/texture/tiles/height.png");
 	unsigned int tilesroughness = loadTexture("../code/assets/texture/tiles/roughness.jpg");
 	unsigned int tilesao = loadTexture("../code/assets/texture/tiles/ao.jpg");
 
 	// Projection
-	glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+	glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, CAMERA_NEAR, CAMERA_FAR);
 	pbrShader.use();
 	pbrShader.setMat4("projection", projection);
-	skyboxShader.use();
-	skyboxShader.setMat4("projection", projection);
 
 	//FPS
 	double lastFPSUpdate = 0.0;
 	int frameCount = 0;
-	//trick
-	int shadowsNeedUpdate = 10;
 	//Matrix Build
 	BuildMatrix();
+	// 室内漫反射环境光和静态图块的光照贴图：读取烘焙结果，缓存缺失或场景变化时不使用，需要用 --bake 重新烘焙
+	initBakedLighting(irradianceMap, marblealbedo, floorAlbedo, tilesalbedo, ceilingalbedo, bakeOnly);
+	if (bakeOnly)
+	{
+		glfwTerminate();
+		return 0;
+	}
+	// 室内镜面反射：局部反射探针，运行时按帧分摊捕获
+	initReflectionProbes(LIBRARY_BOUNDS_MIN, LIBRARY_BOUNDS_MAX);
 
 	// render loop
 	// -----------
@@ -469,6 +663,11 @@ int main()
 
 		processInput(window);
 
+		// 画质调节：按最近的帧时间调整渲染分辨率与画质项
+		updateQualityGovernor(deltaTime * 1000.0);
+		renderWidth = glm::max(1, (int)glm::round(SCR_WIDTH * qualityGovernor.renderScale));
+		renderHeight = glm::max(1, (int)glm::round(SCR_HEIGHT * qualityGovernor.renderScale));
+
 		//FPS
 		frameCount++;
 		if (currentFrame - lastFPSUpdate >= 1.0)
@@ -476,150 +675,519 @@ int main()
 			double fps = (double)frameCount / (currentFrame - lastFPSUpdate);
 			std::string title = "CG_Group8_FinalProject_V2.1 | FPS: " + std::to_string((int)fps);
 			glfwSetWindowTitle(window, title.c_str());
+			printGpuTimers();
+			printLightClusterStats();
+			printRenderGraphStats();
+			printReflectionProbeStats();
+			if (shadowFacesRendered > 0)
+			{
+				std::cout << "[Shadow] cube faces re-rendered: " << shadowFacesRendered;
+				if (shadowCasterCount > 0)
+					std::cout << " | faces per caster: " << (float)shadowCasterFaceDraws / shadowCasterCount;
+				std::cout << " | deferred: " << shadowFacesDeferred << " | max stale frames: " << shadowStaleMax
+					<< " | budget: " << shadowUpdateBudget.texels / (1024 * 1024) << " Mtexels" << std::endl;
+				shadowFacesRendered = 0;
+				shadowCasterFaceDraws = 0;
+				shadowCasterCount = 0;
+				shadowFacesDeferred = 0;
+				shadowStaleMax = 0;
+			}
+			if (useSunLight)
+			{
+				std::cout << "[CSM] casters per cascade:";
+				for (int c = 0; c < CSM_CASCADES; ++c) std::cout << " " << cascadeCasterCounts[c];
+				std::cout << std::endl;
+			}
 			frameCount = 0;
 			lastFPSUpdate = currentFrame;
 		}
 
-		// 清空
-		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// 剔除、级联拟合和运动向量用未抖动的投影，场景通道用 TAA 抖动后的投影
+		glm::mat4 cameraProjection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, CAMERA_NEAR, CAMERA_FAR);
+		glm::mat4 projection = useTAA ? jitterProjection(cameraProjection, renderWidth, renderHeight) : cameraProjection;
+		glm::mat4 view = camera.GetViewMatrix();
+		Frustum frustum(cameraProjection * view);
 
 		// 1. 阴影渲染
-		if (shadowsNeedUpdate) {
-			renderAllObjectsToDepth(depthShader);
-			shadowsNeedUpdate --; // 渲染一次后关闭，除非有物体移动
+		// 先按重要性重新分配阴影图集；只重画分辨率/位置变化的光源和被新增/移动/删除的物体碰到的立方体面
+		// 脏面由调度器按每帧预算分摊到若干帧，光源再多单帧阴影开销也基本不变
+		updateShadowAtlas(frustum);
+		updateShadowCache();
+		size_t scheduledTexels = scheduleShadowUpdates();
+		if (scheduledTexels > 0) {
+			beginGpuTimer("shadow");
+			updateShadowBudget(scheduledTexels);
+			std::vector<ShadowAtlasRect> updatedFaces;
+			renderAllObjectsToDepth(depthFaceShader, updatedFaces);
+			if (shadowFilterMode == SHADOW_FILTER_MOMENTS)
+			{
+				filterShadowMoments(updatedFaces, shadowMomentShader, shadowBlurShader);
+				glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+			}
+			endGpuTimer();
 		}
 
-		// 2. PBR 主渲染
-		pbrShader.use();
-		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-		glm::mat4 view = camera.GetViewMatrix();
-		pbrShader.setMat4("view", view);
-		pbrShader.setMat4("projection", projection);
-		pbrShader.setVec3("camPos", camera.Position);
-		pbrShader.setBool("useInstance",true);
-		// 绑定 IBL 贴图
-		glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-		glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-		glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-
-		// 绑定灯光与阴影贴图
-		int max_light = MAX_POINT_LIGHTS;
-		int validLightCount = min((int)pointLights.size(), max_light);
-		pbrShader.setInt("pointLightCount", validLightCount);
-		for (int i = 0; i < validLightCount; ++i)
+		// 平行光级联阴影：每帧随相机重新拟合并重画，每级只画与该级光源视锥相交的投射者，开销有上限
+		if (useSunLight)
 		{
-			std::string iStr = std::to_string(i);
-			pbrShader.setInt(("pointLightDepthCubemaps[" + iStr + "]").c_str(), 10 + i);
-			pbrShader.setVec3(("pointLightsBase[" + iStr + "].position").c_str(), pointLights[i].position);
-			pbrShader.setVec3(("pointLightsBase[" + iStr + "].color").c_str(), pointLights[i].color);
-			pbrShader.setVec3(("pointLightsBase[" + iStr + "].direction").c_str(), pointLights[i].direction);
-			pbrShader.setFloat(("pointLightsBase[" + iStr + "].cutOff").c_str(), pointLights[i].cutOff);
-			pbrShader.setFloat(("pointLightsBase[" + iStr + "].far_plane").c_str(), pointLights[i].far_plane);
-
-			glActiveTexture(GL_TEXTURE10 + i);
-			glBindTexture(GL_TEXTURE_CUBE_MAP, pointLights[i].depthCubemap);
+			beginGpuTimer("csm");
+			updateCascades(view, glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, CAMERA_NEAR, SUN_DIRECTION);
+			renderCascadedShadows(depthPrepassShader);
+			endGpuTimer();
 		}
 
-		// --- 渲染地面 / 墙壁 / 天花板 ---
-		pbrShader.setInt("albedoMap", 3);
-		pbrShader.setInt("normalMap", 4);
-		pbrShader.setInt("metallicMap", 5);
-		pbrShader.setInt("roughnessMap", 6);
-		pbrShader.setInt("aoMap", 7);
-		pbrShader.setBool("gltf", false);
-		pbrShader.setBool("useAlbedoMap", true);
-		pbrShader.setBool("useNormalMap", true);
-		pbrShader.setBool("useAOMap", false);
-		pbrShader.setBool("useMetallicRoughnessMap", false);
-		pbrShader.setVec4("materialBaseColor", glm::vec4(1.0f));
-		pbrShader.setFloat("materialRoughness", 1.0f);
-		pbrShader.setFloat("materialMetallic", 0.1f);
-		pbrShader.setVec3("environmentLight", glm::vec3(0.05f));
-
-		// 1. 地面 (Marble)
-		pbrShader.setBool("useheightMap", true);
-		glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, marblealbedo);
-		glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, marblenormal);
-		glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, marbleheight);
-		glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, marbleroughness);
-		pbrShader.setBool("useIBL", true);
-		pbrShader.setFloat("texScale", 1.0f); // 调整平铺
-		pbrShader.setFloat("heightScale", 0.005f);
-
-		renderGround(GmodelMatrices, GNormalMatrices);
-
-		pbrShader.setBool("useAOMap", true);
-		// 2. 地板 (floor)
-		glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, floorAlbedo);
-		glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, floorNormal);
-		glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, floorheight);
-		glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, floorRoughness);
-		glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, floorAO);
-		pbrShader.setBool("usePOM", true);
-		pbrShader.setBool("useIBL", false);
-		pbrShader.setFloat("texScale", 1.0f); // 调整平铺
-		pbrShader.setFloat("heightScale", 0.05f);
-
-		renderGround(FmodelMatrices, FNormalMatrices);
-
-		// 3. 墙壁 (Tiles)
-		glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, tilesalbedo);
-		glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, tilesnormal);
-		glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, tilesheight);
-		glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, tilesroughness);
-		glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, tilesao);
-		pbrShader.setBool("useIBL", true);
-		pbrShader.setFloat("texScale", 1.0f);
-		pbrShader.setFloat("heightScale", 0.05f);
-
-		renderWall(WmodelMatrices, WNormalMatrices);
-
-		// 4. 天花板
-		glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, ceilingalbedo);
-		glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, ceilingnormal);
-		glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, ceilingheight);
-		glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, ceilingroughness);
-		glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, ceilingao);
-		renderGround(CmodelMatrices, CNormalMatrices);
-
-		pbrShader.setBool("useheightMap", false);
-		pbrShader.setBool("useInstance", false);
-		pbrShader.setBool("usePOM", false);
-		pbrShader.setBool("useIBL", false);
+		// 场景渲染目标导入渲染图；阴影通道都画完了（它们结束时回到默认帧缓冲），下面的通道都在图里声明
+		ensureSceneTarget(renderWidth, renderHeight);
 
 		//if (!sceneObjects.empty()) 
 		//{
 		//    controlSingleObject(window, sceneObjects.back(), deltaTime); // 控制最后一个添加的物体
 		//}
-		// --- 渲染场景物体 ---
+		// --- 场景物体可见性：剔除、替身、收集透明网格 ---
+		std::vector<Object*> opaqueObjects;
+		std::vector<Impostor*> impostorBatches;
+		std::vector<TransparentDraw> transparentDraws;
 		for (auto& obj : sceneObjects) {
-			obj.Draw(pbrShader);
+			// 视锥剔除
+			glm::mat4 modelMatrix = obj.getModelMatrix();
+			glm::vec3 worldMin, worldMax;
+			transformAABB(modelMatrix, obj.modelData->boundsMin, obj.modelData->boundsMax, worldMin, worldMax);
+			if (!frustum.intersectsAABB(worldMin, worldMax)) continue;
+
+			// 远处的书架/书堆改为替身公告板，攒到一起实例化绘制
+			auto impostor = useImpostors ? impostorCache.find(obj.modelData) : impostorCache.end();
+			if (impostor != impostorCache.end())
+			{
+				glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(impostor->second->center, 1.0f));
+				if (impostorUpright(modelMatrix) && glm::distance(camera.Position, center) > IMPOSTOR_DISTANCE * qualityGovernor.lodDistanceScale)
+				{
+					if (impostor->second->instances.empty()) impostorBatches.push_back(impostor->second);
+					impostor->second->instances.push_back(modelMatrix);
+					continue;
+				}
+			}
+			opaqueObjects.push_back(&obj);
+
+			// 透明网格逐个剔除，按包围盒中心的视深排序
+			for (auto& mesh : obj.modelData->meshes)
+			{
+				if (!mesh.isTransparent()) continue;
+				transformAABB(modelMatrix, mesh.boundsMin, mesh.boundsMax, worldMin, worldMax);
+				if (!frustum.intersectsAABB(worldMin, worldMax)) continue;
+				float viewDepth = glm::dot((worldMin + worldMax) * 0.5f - camera.Position, camera.Front);
+				transparentDraws.push_back({ &obj, &mesh, viewDepth });
+			}
+		}
+
+		// 绑定灯光与阴影图集：分簇光源表每帧按当前视锥重建
+		// 阴影图集/矩/级联是跨帧缓存，不归渲染图管理，在执行前绑好
+		std::vector<ClusterLight> clusterLights;
+		for (const PointLight& light : pointLights)
+		{
+			clusterLights.push_back({ light.position, light.far_plane, light.color, light.shadowIndex, light.direction, light.isSpot() ? light.cutOff : 0.0f });
+		}
+		glActiveTexture(GL_TEXTURE10);
+		glBindTexture(GL_TEXTURE_2D, shadowAtlas.depthTexture);
+		glActiveTexture(GL_TEXTURE11);
+		glBindTexture(GL_TEXTURE_2D, shadowAtlas.depthTexture);
+		glBindSampler(11, shadowAtlas.compareSampler);
+		glActiveTexture(GL_TEXTURE12);
+		glBindTexture(GL_TEXTURE_2D, shadowMoments.texture);
+		glActiveTexture(GL_TEXTURE13);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, cascadedShadowMap.depthArray);
+		bindLightProbes();
+		bindLightmap();
+		buildLightClusters(clusterLights, view, projection, CAMERA_NEAR, CAMERA_FAR);
+		bindLightClusters();
+		// 灯光/IBL 参数始终设置到 pbrShader 上，透明通道仍然前向着色
+		pbrShader.use();
+		pbrShader.setVec3("environmentLight", glm::vec3(0.05f));
+		setPointLightUniforms(pbrShader);
+		setDirLightUniforms(pbrShader);
+		setLightProbeUniforms(pbrShader);
+		setLightmapUniforms(pbrShader); // 延迟模式下透明通道也要把采样器指到 17 号单元，不能与 0 号单元的立方体贴图冲突
+		setReflectionProbeUniforms(pbrShader);
+
+		// 反射探针：每帧推进一步（捕获一个面或预滤波一级 mip），在渲染图之前直接画进探针自己的帧缓冲
+		// 捕获只画不透明场景和天空盒，图块只用反照率贴图，物体按该面的视锥剔除
+		updateReflectionProbes(prefilterShader, camera.Position, [&](const glm::mat4& captureView, const glm::mat4& captureProjection) {
+			Frustum captureFrustum(captureProjection * captureView);
+			glEnable(GL_DEPTH_TEST);
+			glDisable(GL_BLEND);
+			reflectionCaptureShader.use();
+			reflectionCaptureShader.setMat4("view", captureView);
+			reflectionCaptureShader.setMat4("projection", captureProjection);
+			reflectionCaptureShader.setVec3("camPos", glm::vec3(glm::inverse(captureView)[3]));
+			reflectionCaptureShader.setVec3("environmentLight", glm::vec3(0.05f));
+			reflectionCaptureShader.setInt("pointLightCount", (int)clusterLights.size());
+			setPointLightUniforms(reflectionCaptureShader);
+			setLightProbeUniforms(reflectionCaptureShader);
+			setLightmapUniforms(reflectionCaptureShader);
+
+			reflectionCaptureShader.setBool("useInstance", true);
+			reflectionCaptureShader.setBool("gltf", false);
+			reflectionCaptureShader.setBool("useAlbedoMap", true);
+			reflectionCaptureShader.setBool("useNormalMap", false);
+			reflectionCaptureShader.setBool("useAOMap", false);
+			reflectionCaptureShader.setBool("useMetallicRoughnessMap", false);
+			reflectionCaptureShader.setBool("useheightMap", false);
+			reflectionCaptureShader.setBool("usePOM", false);
+			reflectionCaptureShader.setVec4("materialBaseColor", glm::vec4(1.0f));
+			reflectionCaptureShader.setFloat("materialRoughness", 1.0f);
+			reflectionCaptureShader.setFloat("materialMetallic", 0.1f);
+			reflectionCaptureShader.setFloat("texScale", 1.0f);
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, marblealbedo);
+			renderGround(GmodelMatrices, GNormalMatrices);
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, floorAlbedo);
+			reflectionCaptureShader.setInt("lightmapBase", lightmap.floorBase);
+			renderGround(FmodelMatrices, FNormalMatrices);
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, tilesalbedo);
+			reflectionCaptureShader.setInt("lightmapBase", lightmap.wallBase);
+			renderWall(WmodelMatrices, WNormalMatrices);
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, ceilingalbedo);
+			reflectionCaptureShader.setInt("lightmapBase", lightmap.ceilingBase);
+			renderGround(CmodelMatrices, CNormalMatrices);
+			reflectionCaptureShader.setInt("lightmapBase", -1);
+			reflectionCaptureShader.setBool("useInstance", false);
+
+			for (size_t i = 0; i < sceneObjects.size(); ++i)
+			{
+				const ShadowCasterRecord& record = shadowCasterRecords[i];
+				if (!captureFrustum.intersectsAABB(record.worldMin, record.worldMax)) continue;
+				sceneObjects[i].Draw(reflectionCaptureShader);
+			}
+
+			glDepthFunc(GL_LEQUAL);
+			skyboxShader.use();
+			skyboxShader.setMat4("view", captureView);
+			skyboxShader.setMat4("projection", captureProjection);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+			renderCube();
+			glDepthFunc(GL_LESS);
+		});
+		bindReflectionProbes();
+
+		// --- 渲染图：声明本帧的通道及其读写的纹理，编译（排序、剔除、分配临时纹理）后执行 ---
+		beginRenderGraph();
+		RGHandle sceneColor = rgImportTexture("scene color", sceneTarget.colorTexture, renderWidth, renderHeight, GL_RGBA16F);
+		RGHandle sceneDepth = rgImportTexture("scene depth", sceneTarget.depthTexture, renderWidth, renderHeight, GL_DEPTH24_STENCIL8);
+
+		rgAddPass("clear", {}, { sceneColor }, sceneDepth, [&]() {
+			glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		});
+
+		// 延迟模式下预通道和不透明通道都写进 G-buffer
+		GBufferTargets gbuffer;
+		std::vector<RGHandle> geometryColors = { sceneColor };
+		RGHandle geometryDepth = sceneDepth;
+		if (useDeferred)
+		{
+			gbuffer = createGBufferTargets(renderWidth, renderHeight);
+			geometryColors = gbuffer.colors();
+			geometryDepth = gbuffer.depth;
+			rgAddPass("gbuffer clear", {}, geometryColors, geometryDepth, [&]() {
+				clearGBuffer();
+			});
+		}
+		std::vector<RGHandle> geometryReads = geometryColors;
+		geometryReads.push_back(geometryDepth);
+
+		// 2. 深度预通道：只写深度，之后的着色通道用 GL_EQUAL，每个像素只跑一次 pbr.fs
+		if (useDepthPrepass)
+		{
+			rgAddPass("prepass", { geometryDepth }, {}, geometryDepth, [&]() {
+				beginGpuTimer("prepass");
+				glDisable(GL_BLEND);
+				depthPrepassShader.use();
+				depthPrepassShader.setMat4("view", view);
+				depthPrepassShader.setMat4("projection", projection);
+				depthPrepassShader.setBool("useInstance", true);
+				renderGround(GmodelMatrices, GNormalMatrices, true);
+				renderGround(FmodelMatrices, FNormalMatrices, true);
+				renderWall(WmodelMatrices, WNormalMatrices, true);
+				renderGround(CmodelMatrices, CNormalMatrices, true);
+				depthPrepassShader.setBool("useInstance", false);
+				for (Object* obj : opaqueObjects)
+				{
+					obj->DrawPrepass(depthPrepassShader);
+				}
+				glDepthMask(GL_FALSE);
+				glDepthFunc(GL_EQUAL);
+				endGpuTimer();
+			});
+		}
+
+		// 屏幕空间阴影遮罩：预通道深度已就绪，每个像素只算一次点光源阴影，不透明通道直接读取
+		// 遮罩关闭时不透明通道不读它，两个遮罩通道由渲染图剔除
+		ShadowMaskTargets shadowMaskTargets;
+		bool shadowMaskActive = !useDeferred && useDepthPrepass && shadowMaskMode != SHADOW_MASK_OFF;
+		if (!useDeferred && useDepthPrepass)
+		{
+			shadowMaskTargets = addShadowMaskPasses(shadowMaskShader, projection * view, sceneDepth, renderWidth, renderHeight,
+				shadowMaskMode == SHADOW_MASK_HALF ? 2 : 1, [&]() {
+					shadowMaskShader.setVec3("camPos", camera.Position);
+					setPointLightUniforms(shadowMaskShader);
+					setDirLightUniforms(shadowMaskShader);
+				});
+			if (shadowMaskActive)
+			{
+				geometryReads.push_back(shadowMaskTargets.mask);
+				geometryReads.push_back(shadowMaskTargets.depth);
+			}
+		}
+
+		// 3. PBR 主渲染（不透明通道，关闭混合）；延迟模式下改为写 G-buffer 的几何通道
+		rgAddPass(useDeferred ? "gbuffer" : "opaque", geometryReads, geometryColors, geometryDepth, [&]() {
+			glDisable(GL_BLEND);
+			pbrShader.use();
+			pbrShader.setMat4("view", view);
+			pbrShader.setMat4("projection", projection);
+			pbrShader.setVec3("camPos", camera.Position);
+			// 绑定 IBL 贴图
+			glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+			glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+			glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+			if (shadowMaskActive) bindShadowMask(pbrShader, shadowMaskTargets);
+			else pbrShader.setBool("useShadowMask", false);
+
+			beginGpuTimer(useDeferred ? "gbuffer" : "opaque");
+			Shader& opaqueShader = useDeferred ? gbufferShader : pbrShader;
+			opaqueShader.use();
+			opaqueShader.setMat4("view", view);
+			opaqueShader.setMat4("projection", projection);
+			opaqueShader.setVec3("camPos", camera.Position);
+			opaqueShader.setBool("useInstance", true);
+
+			// --- 渲染地面 / 墙壁 / 天花板 ---
+			opaqueShader.setInt("albedoMap", 3);
+			opaqueShader.setInt("normalMap", 4);
+			opaqueShader.setInt("metallicMap", 5);
+			opaqueShader.setInt("roughnessMap", 6);
+			opaqueShader.setInt("aoMap", 7);
+			opaqueShader.setBool("gltf", false);
+			opaqueShader.setBool("useAlbedoMap", true);
+			opaqueShader.setBool("useNormalMap", true);
+			opaqueShader.setBool("useAOMap", false);
+			opaqueShader.setBool("useMetallicRoughnessMap", false);
+			opaqueShader.setVec4("materialBaseColor", glm::vec4(1.0f));
+			opaqueShader.setFloat("materialRoughness", 1.0f);
+			opaqueShader.setFloat("materialMetallic", 0.1f);
+
+			// 1. 地面 (Marble)
+			opaqueShader.setBool("useheightMap", true);
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, marblealbedo);
+			glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, marblenormal);
+			glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, marbleheight);
+			glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, marbleroughness);
+			opaqueShader.setBool("useIBL", true);
+			opaqueShader.setFloat("texScale", 1.0f); // 调整平铺
+			opaqueShader.setFloat("heightScale", 0.005f);
+			opaqueShader.setInt("pomMaxSteps", useTAA ? glm::min(qualityGovernor.pomMaxSteps, TAA_POM_MAX_STEPS) : qualityGovernor.pomMaxSteps);
+			setLightmapUniforms(opaqueShader); // 室外地面没有光照贴图
+
+			renderGround(GmodelMatrices, GNormalMatrices);
+
+			opaqueShader.setBool("useAOMap", true);
+			// 2. 地板 (floor)
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, floorAlbedo);
+			glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, floorNormal);
+			glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, floorheight);
+			glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, floorRoughness);
+			glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, floorAO);
+			opaqueShader.setBool("usePOM", true);
+			opaqueShader.setBool("useIBL", false);
+			opaqueShader.setFloat("texScale", 1.0f); // 调整平铺
+			opaqueShader.setFloat("heightScale", 0.05f);
+
+			opaqueShader.setInt("lightmapBase", lightmap.floorBase);
+
+			renderGround(FmodelMatrices, FNormalMatrices);
+
+			// 3. 墙壁 (Tiles)
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, tilesalbedo);
+			glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, tilesnormal);
+			glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, tilesheight);
+			glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, tilesroughness);
+			glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, tilesao);
+			opaqueShader.setBool("useIBL", true);
+			opaqueShader.setFloat("texScale", 1.0f);
+			opaqueShader.setFloat("heightScale", 0.05f);
+
+			opaqueShader.setInt("lightmapBase", lightmap.wallBase);
+
+			renderWall(WmodelMatrices, WNormalMatrices);
+
+			// 4. 天花板
+			glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, ceilingalbedo);
+			glActiveTexture(GL_TEXTURE4); glBindTexture(GL_TEXTURE_2D, ceilingnormal);
+			glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, ceilingheight);
+			glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_2D, ceilingroughness);
+			glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_2D, ceilingao);
+			opaqueShader.setInt("lightmapBase", lightmap.ceilingBase);
+			renderGround(CmodelMatrices, CNormalMatrices);
+			opaqueShader.setInt("lightmapBase", -1);
+
+			opaqueShader.setBool("useheightMap", false);
+			opaqueShader.setBool("useInstance", false);
+			opaqueShader.setBool("usePOM", false);
+			opaqueShader.setBool("useIBL", false);
+
+			// --- 渲染场景物体 ---
+			for (Object* obj : opaqueObjects)
+			{
+				obj->Draw(opaqueShader);
+			}
+			endGpuTimer();
+			if (useDepthPrepass)
+			{
+				glDepthMask(GL_TRUE);
+				glDepthFunc(GL_LESS);
+			}
+		});
+
+		// 延迟光照：每个像素一次，结果和深度写回场景渲染目标
+		if (useDeferred)
+		{
+			std::vector<RGHandle> lightingReads = geometryReads;
+			lightingReads.push_back(sceneColor);
+			rgAddPass("lighting", lightingReads, { sceneColor }, sceneDepth, [&]() {
+				beginGpuTimer("lighting");
+				deferredLightingShader.use();
+				deferredLightingShader.setVec3("camPos", camera.Position);
+				deferredLightingShader.setVec3("environmentLight", glm::vec3(0.05f));
+				setPointLightUniforms(deferredLightingShader);
+				setDirLightUniforms(deferredLightingShader);
+				setLightProbeUniforms(deferredLightingShader);
+				setReflectionProbeUniforms(deferredLightingShader);
+				renderDeferredLighting(deferredLightingShader, projection * view, gbuffer);
+				endGpuTimer();
+			});
+		}
+
+		// --- 远景替身 ---
+		if (!impostorBatches.empty())
+		{
+			rgAddPass("impostors", { sceneColor, sceneDepth }, { sceneColor }, sceneDepth, [&]() {
+				impostorShader.use();
+				impostorShader.setMat4("view", view);
+				impostorShader.setMat4("projection", projection);
+				impostorShader.setVec3("camPos", camera.Position);
+				impostorShader.setVec3("environmentLight", glm::vec3(0.05f));
+				setPointLightUniforms(impostorShader);
+				renderImpostors(impostorBatches, impostorShader);
+			});
 		}
 
 		// --- 天空盒 ---
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LEQUAL);
-		skyboxShader.use();
-		skyboxShader.setMat4("view", view);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
-		renderCube();
-		glDepthFunc(GL_LESS);
+		rgAddPass("skybox", { sceneColor, sceneDepth }, { sceneColor }, sceneDepth, [&]() {
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_LEQUAL);
+			skyboxShader.use();
+			skyboxShader.setMat4("view", view);
+			skyboxShader.setMat4("projection", projection);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+			renderCube();
+			glDepthFunc(GL_LESS);
+		});
+
+		// --- 透明通道：整个通道只设置一次混合/深度写入状态 ---
+		// 排序模式从远到近绘制；加权混合 OIT 模式不排序，累积后一次合成
+		if (!transparentDraws.empty())
+		{
+			auto drawTransparent = [&]() {
+				beginGpuTimer("transparent");
+				pbrShader.use();
+				pbrShader.setBool("useShadowMask", false); // 遮罩只对应不透明表面的深度
+				pbrShader.setBool("oitPass", useWeightedOIT);
+				glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // 天空盒占用了 0 号单元
+				Object* currentObject = nullptr;
+				for (auto& draw : transparentDraws)
+				{
+					if (draw.object != currentObject)
+					{
+						currentObject = draw.object;
+						currentObject->setUniforms(pbrShader);
+						pbrShader.setBool("gltf", currentObject->modelData->gltf);
+					}
+					draw.mesh->Draw(pbrShader);
+				}
+				pbrShader.setBool("useIBL", false);
+				pbrShader.setBool("oitPass", false);
+				endGpuTimer();
+			};
+
+			if (useWeightedOIT)
+			{
+				addWeightedOITPasses(oitCompositeShader, sceneColor, sceneDepth, renderWidth, renderHeight, drawTransparent);
+			}
+			else
+			{
+				std::sort(transparentDraws.begin(), transparentDraws.end(),
+					[](const TransparentDraw& a, const TransparentDraw& b) { return a.viewDepth > b.viewDepth; });
+				// drawTransparent 只活在这个块里，通道要到 executeRenderGraph 才执行，必须按值捕获
+				rgAddPass("transparent", { sceneColor, sceneDepth }, { sceneColor }, sceneDepth, [drawTransparent]() {
+					glEnable(GL_BLEND);
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					glDepthMask(GL_FALSE);
+					drawTransparent();
+					glDepthMask(GL_TRUE);
+					glDisable(GL_BLEND);
+				});
+			}
+		}
 
+		// 时间抗锯齿，然后后处理（泛光、色调映射、gamma）并放大到窗口
+		RGHandle hdrColor = sceneColor;
+		if (useTAA)
+		{
+			hdrColor = addTemporalAAPasses(velocityShader, taaShader, projection * view, cameraProjection * view, sceneColor, sceneDepth, renderWidth, renderHeight);
+		}
+		addPostProcessPass(postShader, bloomDownsampleShader, bloomUpsampleShader, hdrColor, renderWidth, renderHeight, SCR_WIDTH, SCR_HEIGHT);
+
+		compileRenderGraph();
+		executeRenderGraph();
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
 	// 资源清理
-	for (auto& light : pointLights) {
-		glDeleteTextures(1, &light.depthCubemap);
-		glDeleteFramebuffers(1, &light.depthFBO);
-	}
+	glDeleteFramebuffers(1, &shadowAtlas.fbo);
+	glDeleteTextures(1, &shadowAtlas.depthTexture);
+	glDeleteSamplers(1, &shadowAtlas.compareSampler);
+	glDeleteFramebuffers(1, &shadowMoments.fbo);
+	glDeleteTextures(1, &shadowMoments.texture);
+	glDeleteFramebuffers(2, shadowMoments.scratchFBO);
+	glDeleteTextures(2, shadowMoments.scratchTexture);
+	glDeleteFramebuffers(1, &cascadedShadowMap.fbo);
+	glDeleteTextures(1, &cascadedShadowMap.depthArray);
+	glDeleteTextures(1, &sceneTarget.colorTexture);
+	glDeleteTextures(1, &sceneTarget.depthTexture);
+	glDeleteTextures(2, temporalAA.history);
+	releaseRenderGraph();
+	glDeleteTextures(1, &lightProbeGrid.texture);
+	glDeleteTextures(1, &lightmap.texture);
+	releaseReflectionProbes();
 	glDeleteTextures(1, &envCubemap);
 	glDeleteTextures(1, &irradianceMap);
 	glDeleteTextures(1, &prefilterMap);
 	glDeleteTextures(1, &brdfLUTTexture);
+	for (auto& entry : impostorCache) {
+		glDeleteTextures(1, &entry.second->albedoAtlas);
+		glDeleteTextures(1, &entry.second->normalAtlas);
+		glDeleteTextures(1, &entry.second->depthAtlas);
+		delete entry.second;
+	}
+	impostorCache.clear();
+	glDeleteBuffers(1, &lightClusters.lightBuffer);
+	glDeleteBuffers(1, &lightClusters.clusterBuffer);
+	glDeleteTextures(1, &lightClusters.lightTexture);
+	glDeleteTextures(1, &lightClusters.clusterTexture);
+	for (auto& entry : gpuTimers) {
+		glDeleteQueries(GpuTimer::LATENCY, entry.second.queries);
+	}
 
 	// 清理模型资源
 	modelCache.clear();
@@ -630,39 +1198,123 @@ int main()
 
 // =======================================================
 // 工具函数实现
-void renderAllObjectsToDepth(Shader& depthShader)
+// 单元网格实例的世界包围盒（矩阵在 BuildMatrix 之后不再变化）
+struct TileCasterGroup
 {
-	depthShader.use();
-	glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+	const std::vector<glm::mat4>* matrices;
+	const std::vector<glm::mat3>* normals;
+	bool wall;
+	std::vector<glm::vec3> worldMin, worldMax;
+};
+
+// 首次使用时计算，点光源阴影与级联阴影共用
+std::vector<TileCasterGroup>& shadowTileGroups()
+{
+	static std::vector<TileCasterGroup> tileGroups;
+	if (tileGroups.empty())
+	{
+		tileGroups = {
+			{ &GmodelMatrices, &GNormalMatrices, false, {}, {} },
+			{ &FmodelMatrices, &FNormalMatrices, false, {}, {} },
+			{ &WmodelMatrices, &WNormalMatrices, true, {}, {} },
+			{ &CmodelMatrices, &CNormalMatrices, false, {}, {} },
+		};
+		for (auto& group : tileGroups)
+		{
+			group.worldMin.resize(group.matrices->size());
+			group.worldMax.resize(group.matrices->size());
+			for (size_t i = 0; i < group.matrices->size(); ++i)
+				transformAABB((*group.matrices)[i], TILE_BOUNDS_MIN, TILE_BOUNDS_MAX, group.worldMin[i], group.worldMax[i]);
+		}
+	}
+	return tileGroups;
+}
+
+void renderAllObjectsToDepth(Shader& depthFaceShader, std::vector<ShadowAtlasRect>& updatedFaces)
+{
+	const std::vector<TileCasterGroup>& tileGroups = shadowTileGroups();
+
+	// 所有面都画进同一张阴影图集，视口和裁剪框限定在各自的区域内
+	glBindFramebuffer(GL_FRAMEBUFFER, shadowAtlas.fbo);
+	glEnable(GL_SCISSOR_TEST);
+	depthFaceShader.use();
 
 	// 开启正面剔除以修复阴影痤疮
 	glCullFace(GL_FRONT);
 
+	std::vector<unsigned int> tileMasks[4];
+	std::vector<unsigned int> objectMasks(sceneObjects.size());
+	std::vector<glm::mat4> faceTiles;
 	for (auto& light : pointLights)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, light.depthFBO);
-		glClear(GL_DEPTH_BUFFER_BIT);
+		if (light.shadowIndex < 0 || light.scheduledFaces == 0) continue;
 
-		for (unsigned int i = 0; i < 6; ++i)
+		// 1. 先用光源范围球、再用各面视锥剔除投射者，得到每个投射者需要画到的本帧调度面
+		for (size_t g = 0; g < tileGroups.size(); ++g)
 		{
-			depthShader.setMat4(("shadowMatrices[" + std::to_string(i) + "]").c_str(), light.shadowMatrices[i]);
+			const TileCasterGroup& group = tileGroups[g];
+			tileMasks[g].resize(group.matrices->size());
+			for (size_t i = 0; i < group.matrices->size(); ++i)
+			{
+				tileMasks[g][i] = light.scheduledFaces & shadowFacesTouched(light.position, light.far_plane, light.faceFrusta, light.shadowFaceTotal(), group.worldMin[i], group.worldMax[i]);
+				if (tileMasks[g][i] == 0) continue;
+				shadowCasterCount++;
+				shadowCasterFaceDraws += shadowFaceCount(tileMasks[g][i]);
+			}
+		}
+		for (size_t i = 0; i < sceneObjects.size(); ++i)
+		{
+			const ShadowCasterRecord& record = shadowCasterRecords[i];
+			objectMasks[i] = light.scheduledFaces & shadowFacesTouched(light.position, light.far_plane, light.faceFrusta, light.shadowFaceTotal(), record.worldMin, record.worldMax);
+			if (objectMasks[i] == 0) continue;
+			shadowCasterCount++;
+			shadowCasterFaceDraws += shadowFaceCount(objectMasks[i]);
 		}
-		depthShader.setVec3("lightPos", light.position);
-		depthShader.setFloat("far_plane", light.far_plane);
 
-		depthShader.setBool("useInstance", true);
-		renderGround(GmodelMatrices, GNormalMatrices, true);
-		renderGround(FmodelMatrices, FNormalMatrices,true);
-		renderWall(WmodelMatrices, WNormalMatrices, true);
-		renderGround(CmodelMatrices, CNormalMatrices, true);
-		depthShader.setBool("useInstance", false);
-		 //2. 渲染场景对象
-		for (auto& obj : sceneObjects)
+		// 2. 逐面渲染：只提交碰到该面的单元网格实例和物体
+		depthFaceShader.setVec3("lightPos", light.position);
+		depthFaceShader.setFloat("far_plane", light.far_plane);
+		for (unsigned int face = 0; face < 6; ++face)
 		{
-			obj.DrawDepth(depthShader);
+			unsigned int bit = 1u << face;
+			if (!(light.scheduledFaces & bit)) continue;
+			const ShadowAtlasRect& rect = light.atlasRects[face];
+			glViewport(rect.x, rect.y, rect.size, rect.size);
+			glScissor(rect.x, rect.y, rect.size, rect.size);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			depthFaceShader.setMat4("shadowMatrix", light.shadowMatrices[face]);
+
+			depthFaceShader.setBool("useInstance", true);
+			for (size_t g = 0; g < tileGroups.size(); ++g)
+			{
+				const TileCasterGroup& group = tileGroups[g];
+				faceTiles.clear();
+				for (size_t i = 0; i < group.matrices->size(); ++i)
+				{
+					if (tileMasks[g][i] & bit) faceTiles.push_back((*group.matrices)[i]);
+				}
+				if (group.wall) renderWall(faceTiles, *group.normals, true);
+				else renderGround(faceTiles, *group.normals, true);
+			}
+			depthFaceShader.setBool("useInstance", false);
+			for (size_t i = 0; i < sceneObjects.size(); ++i)
+			{
+				if (objectMasks[i] & bit) sceneObjects[i].DrawDepth(depthFaceShader, useShadowProxies);
+			}
+			updatedFaces.push_back(rect);
 		}
+
+		shadowFacesRendered += shadowFaceCount(light.scheduledFaces);
+		for (int face = 0; face < 6; ++face)
+		{
+			if (light.scheduledFaces & (1u << face)) light.staleFrames[face] = 0;
+		}
+		light.dirtyFaces &= ~light.scheduledFaces;
+		light.validFaces |= light.scheduledFaces;
+		light.scheduledFaces = 0;
 	}
 
+	glDisable(GL_SCISSOR_TEST);
 	glCullFace(GL_BACK); // 恢复背面剔除
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
@@ -670,47 +1322,392 @@ void renderAllObjectsToDepth(Shader& depthShader)
 
 }
 
-void initPointLights()
+// 级联阴影：逐级绑定纹理数组的一层，只提交包围盒与该级光源视锥相交的单元网格实例和物体
+void renderCascadedShadows(Shader& depthShader)
+{
+	ensureCascadedShadowMap();
+	const std::vector<TileCasterGroup>& tileGroups = shadowTileGroups();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, cascadedShadowMap.fbo);
+	glViewport(0, 0, CSM_RESOLUTION, CSM_RESOLUTION);
+	glCullFace(GL_FRONT);
+	depthShader.use();
+
+	std::vector<glm::mat4> cascadeTiles;
+	for (int c = 0; c < CSM_CASCADES; ++c)
+	{
+		const Frustum& cascadeFrustum = cascadedShadowMap.frusta[c];
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cascadedShadowMap.depthArray, 0, c);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		depthShader.setMat4("view", cascadedShadowMap.lightViews[c]);
+		depthShader.setMat4("projection", cascadedShadowMap.lightProjections[c]);
+		cascadeCasterCounts[c] = 0;
+
+		depthShader.setBool("useInstance", true);
+		for (const TileCasterGroup& group : tileGroups)
+		{
+			cascadeTiles.clear();
+			for (size_t i = 0; i < group.matrices->size(); ++i)
+			{
+				if (cascadeFrustum.intersectsAABB(group.worldMin[i], group.worldMax[i]))
+					cascadeTiles.push_back((*group.matrices)[i]);
+			}
+			cascadeCasterCounts[c] += (int)cascadeTiles.size();
+			if (group.wall) renderWall(cascadeTiles, *group.normals, true);
+			else renderGround(cascadeTiles, *group.normals, true);
+		}
+		depthShader.setBool("useInstance", false);
+		for (size_t i = 0; i < sceneObjects.size(); ++i)
+		{
+			const ShadowCasterRecord& record = shadowCasterRecords[i];
+			if (!cascadeFrustum.intersectsAABB(record.worldMin, record.worldMax)) continue;
+			sceneObjects[i].DrawDepth(depthShader, useShadowProxies);
+			cascadeCasterCounts[c]++;
+		}
+	}
+
+	glCullFace(GL_BACK);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+}
+
+// 太阳参数与各级联的矩阵，纹理数组绑定在 13 号纹理单元
+void setDirLightUniforms(Shader& shader)
+{
+	shader.setVec3("dirLight.direction", SUN_DIRECTION);
+	shader.setVec3("dirLight.color", SUN_COLOR);
+	shader.setBool("dirLight.enabled", useSunLight);
+	shader.setInt("dirShadowMap", 13);
+	shader.setInt("cascadeCount", CSM_CASCADES);
+	for (int c = 0; c < CSM_CASCADES; ++c)
+	{
+		shader.setMat4(("dirLightMatrices[" + std::to_string(c) + "]").c_str(), cascadedShadowMap.lightMatrices[c]);
+		shader.setFloat(("cascadeTexelSizes[" + std::to_string(c) + "]").c_str(), cascadedShadowMap.texelSizes[c]);
+	}
+}
+
+// 辐照度探针和光照贴图：把场景（不透明网格 + 地面/墙体单元）和灯光交给 CPU 烘焙器，结果按场景哈希分别缓存到
+// LIGHT_PROBE_PATH 和 LIGHTMAP_PATH；光照贴图的间接光要用探针，所以先探针后贴图，两者共用一棵 BVH（需要烘焙时才构建）
+// 网格反照率 = 材质基础色 x 反照率贴图的平均色（烘焙只需要低频）；透明网格（窗玻璃）不挡光，天空从门窗照进来
+// bake 为 true 时忽略缓存重新烘焙并保存；否则只读缓存，缓存不匹配时不上传纹理（着色器里等同关闭）
+void initBakedLighting(unsigned int skyIrradiance, unsigned int groundAlbedo, unsigned int floorAlbedo, unsigned int wallAlbedo, unsigned int ceilingAlbedo, bool bake)
+{
+	initLightProbeGrid(lightProbeGrid, LIBRARY_BOUNDS_MIN, LIBRARY_BOUNDS_MAX);
+
+	ProbeScene scene;
+	std::map<unsigned int, glm::vec3> textureAlbedo;
+	auto albedoOf = [&](unsigned int texture) {
+		auto it = textureAlbedo.find(texture);
+		if (it == textureAlbedo.end()) it = textureAlbedo.insert({ texture, averageTextureColor(texture) }).first;
+		return it->second;
+	};
+	for (const Object& obj : sceneObjects)
+	{
+		glm::mat4 modelMatrix = obj.getModelMatrix();
+		for (const Mesh& mesh : obj.modelData->meshes)
+		{
+			if (mesh.isTransparent()) continue;
+			glm::vec3 albedo = glm::vec3(mesh.baseColorFactor);
+			for (const Texture& texture : mesh.textures)
+			{
+				if (texture.type == "albedoMap") albedo *= albedoOf(texture.id);
+			}
+			addProbeMesh(scene, mesh, modelMatrix, albedo);
+		}
+	}
+	const std::pair<const std::vector<glm::mat4>*, unsigned int> tiles[] = {
+		{ &GmodelMatrices, groundAlbedo }, { &FmodelMatrices, floorAlbedo }, { &WmodelMatrices, wallAlbedo }, { &CmodelMatrices, ceilingAlbedo },
+	};
+	for (const auto& tile : tiles)
+	{
+		glm::vec3 albedo = albedoOf(tile.second);
+		for (const glm::mat4& modelMatrix : *tile.first)
+			addProbeBox(scene, modelMatrix, TILE_BOUNDS_MIN, TILE_BOUNDS_MAX, albedo);
+	}
+
+	std::vector<ProbeLight> lights;
+	for (const PointLight& light : pointLights)
+	{
+		lights.push_back({ light.position, light.color, light.direction, light.isSpot() ? light.cutOff : 0.0f, light.far_plane });
+	}
+
+	ProbeSky sky;
+	uint32_t hash = lightProbeSceneHash(lightProbeGrid, scene, lights);
+	if (bake)
+	{
+		std::cout << "[LightProbes] baking " << LIGHT_PROBE_PATH << " ..." << std::endl;
+		buildProbeBVH(scene);
+		sky = readProbeSky(skyIrradiance);
+		bakeLightProbes(lightProbeGrid, scene, lights, sky);
+		saveLightProbes(lightProbeGrid, LIGHT_PROBE_PATH, hash);
+	}
+	else if (loadLightProbes(lightProbeGrid, LIGHT_PROBE_PATH, hash))
+	{
+		std::cout << "[LightProbes] loaded " << LIGHT_PROBE_PATH << std::endl;
+		uploadLightProbes(lightProbeGrid);
+	}
+	else
+	{
+		std::cout << "[LightProbes] " << LIGHT_PROBE_PATH << " missing or out of date, run with --bake" << std::endl;
+	}
+
+	// 图表顺序与绘制时的 lightmapBase 一致：地板、墙、天花板
+	initLightmapLayout(lightmap, (int)FmodelMatrices.size(), (int)WmodelMatrices.size(), (int)CmodelMatrices.size());
+	std::vector<LightmapChart> charts;
+	addLightmapCharts(charts, FmodelMatrices);
+	addLightmapCharts(charts, WmodelMatrices);
+	addLightmapCharts(charts, CmodelMatrices);
+
+	uint32_t lightmapKey = lightmapHash(lightmap, hash);
+	if (bake)
+	{
+		std::cout << "[Lightmap] baking " << LIGHTMAP_PATH << " ..." << std::endl;
+		bakeLightmap(lightmap, charts, scene, lights, sky, lightProbeGrid, LIBRARY_BOUNDS_MIN, LIBRARY_BOUNDS_MAX);
+		saveLightmap(lightmap, LIGHTMAP_PATH, lightmapKey);
+	}
+	else if (loadLightmap(lightmap, LIGHTMAP_PATH, lightmapKey))
+	{
+		std::cout << "[Lightmap] loaded " << LIGHTMAP_PATH << std::endl;
+		uploadLightmap(lightmap);
+	}
+	else
+	{
+		std::cout << "[Lightmap] " << LIGHTMAP_PATH << " missing or out of date, run with --bake" << std::endl;
+	}
+}
+
+// 阴影重要性：期望分辨率占 SHADOW_FACE_MAX 的比例
+// 光源与相机的距离不超过其范围的 1/4 时用满分辨率，距离每翻倍减半；范围球不在视锥内的光源只给最低档
+float shadowImportance(const PointLight& light, const Frustum& frustum)
+{
+	glm::vec3 extent(light.far_plane);
+	if (!frustum.intersectsAABB(light.position - extent, light.position + extent)) return 0.0f;
+	float distance = glm::max(glm::distance(camera.Position, light.position), 0.001f);
+	return glm::min(0.25f * light.far_plane / distance, 1.0f);
+}
+
+// 每帧重新选择各光源的面分辨率并打包图集；格式切换或某个光源的区域变化时把它的 6 个面全部标脏并标记为无效
+void updateShadowAtlas(const Frustum& frustum)
 {
+	bool reallocated = ensureShadowAtlas(useShadowDepth16);
+
+	std::vector<PointLight*> shadowed;
+	std::vector<float> importance;
+	std::vector<int> faceSizes;
+	std::vector<int> faceCounts;
 	for (auto& light : pointLights)
 	{
-		// 创建深度 FBO
-		glGenFramebuffers(1, &light.depthFBO);
-		// 创建立方体深度纹理
-		glGenTextures(1, &light.depthCubemap);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, light.depthCubemap);
-		for (unsigned int i = 0; i < 6; ++i)
+		if (light.shadowIndex < 0) continue;
+		// 光源移动/转向后重建阴影矩阵；旧内容在重画前继续使用
+		if (light.position != light.shadowOrigin || light.direction != light.shadowDirection)
+		{
+			updatePointLightShadowMatrices(light);
+			light.dirtyFaces = SHADOW_ALL_FACES;
+		}
+		float value = shadowImportance(light, frustum);
+		light.importance = value;
+		shadowed.push_back(&light);
+		importance.push_back(value);
+		light.requestedResolution = shadowFaceResolution(value, light.requestedResolution);
+		faceSizes.push_back(light.requestedResolution);
+		faceCounts.push_back(light.shadowFaceTotal());
+	}
+	fitShadowBudget(importance, faceCounts, faceSizes);
+
+	std::vector<ShadowAtlasRect> rects;
+	packShadowAtlas(faceSizes, faceCounts, rects);
+
+	bool changed = false;
+	for (size_t i = 0; i < shadowed.size(); ++i)
+	{
+		PointLight& light = *shadowed[i];
+		bool moved = light.shadowResolution != faceSizes[i];
+		for (int face = 0; face < 6; ++face)
+		{
+			const ShadowAtlasRect& rect = rects[i * 6 + face];
+			moved |= light.atlasRects[face].x != rect.x || light.atlasRects[face].y != rect.y;
+			light.atlasRects[face] = rect;
+		}
+		light.shadowResolution = faceSizes[i];
+		if (moved || reallocated)
+		{
+			light.dirtyFaces = SHADOW_ALL_FACES;
+			light.validFaces = 0;
+		}
+		changed |= moved;
+	}
+
+	if (changed)
+	{
+		std::cout << "[Shadow] atlas face sizes:";
+		for (int size : faceSizes) std::cout << " " << size;
+		std::cout << std::endl;
+	}
+}
+
+// 收集所有脏面交给调度器，选中的面记在 scheduledFaces 里，其余面等待帧数加一；返回本帧要画的纹素数
+size_t scheduleShadowUpdates()
+{
+	std::vector<ShadowFaceRequest> requests;
+	for (size_t l = 0; l < pointLights.size(); ++l)
+	{
+		PointLight& light = pointLights[l];
+		light.scheduledFaces = 0;
+		light.dirtyFaces &= light.shadowFaceMask(); // 聚光灯只有第 0 面
+		if (light.shadowIndex < 0 || light.dirtyFaces == 0) continue;
+		if (light.shadowResolution == 0)
+		{
+			light.dirtyFaces = 0; // 没分到图集空间，重新分到时会整体标脏
+			continue;
+		}
+		for (int face = 0; face < 6; ++face)
+		{
+			unsigned int bit = 1u << face;
+			if (!(light.dirtyFaces & bit)) continue;
+			requests.push_back({ l, face, light.shadowResolution, light.importance, light.staleFrames[face], (light.validFaces & bit) != 0 });
+		}
+	}
+
+	size_t texels = 0;
+	std::vector<size_t> selected = scheduleShadowFaces(requests, texels);
+	for (size_t i : selected)
+		pointLights[requests[i].light].scheduledFaces |= 1u << requests[i].face;
+	for (const ShadowFaceRequest& request : requests)
+	{
+		PointLight& light = pointLights[request.light];
+		if (light.scheduledFaces & (1u << request.face)) continue;
+		light.staleFrames[request.face]++;
+		shadowFacesDeferred++;
+		shadowStaleMax = std::max(shadowStaleMax, light.staleFrames[request.face]);
+	}
+	return texels;
+}
+
+// 对比上次记录的物体状态，把新增/移动/删除的物体（新旧包围盒）碰到的阴影面标脏
+void updateShadowCache()
+{
+	auto invalidate = [](const glm::vec3& worldMin, const glm::vec3& worldMax)
+		{
+			for (auto& light : pointLights)
+			{
+				if (light.shadowIndex < 0) continue;
+				light.dirtyFaces |= shadowFacesTouched(light.position, light.far_plane, light.faceFrusta, light.shadowFaceTotal(), worldMin, worldMax);
+			}
+			invalidateReflectionProbes(worldMin, worldMax);
+		};
+
+	size_t count = std::max(sceneObjects.size(), shadowCasterRecords.size());
+	std::vector<ShadowCasterRecord> records(sceneObjects.size());
+	for (size_t i = 0; i < count; ++i)
+	{
+		bool hadRecord = i < shadowCasterRecords.size();
+		bool hasObject = i < sceneObjects.size();
+		if (hasObject)
 		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT32F,
-				SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+			const Object& obj = sceneObjects[i];
+			records[i].model = obj.modelData;
+			transformAABB(obj.getModelMatrix(), obj.modelData->boundsMin, obj.modelData->boundsMax, records[i].worldMin, records[i].worldMax);
 		}
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-		glBindFramebuffer(GL_FRAMEBUFFER, light.depthFBO);
-		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, light.depthCubemap, 0);
-		glDrawBuffer(GL_NONE);
-		glReadBuffer(GL_NONE);
-
-		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+
+		if (hadRecord && hasObject)
 		{
-			std::cerr << "ERROR::FRAMEBUFFER:: Point light FBO incomplete! Error code: "
-				<< glCheckFramebufferStatus(GL_FRAMEBUFFER) << std::endl;
-			exit(-1);
+			const ShadowCasterRecord& old = shadowCasterRecords[i];
+			if (old.model == records[i].model && old.worldMin == records[i].worldMin && old.worldMax == records[i].worldMax)
+				continue;
 		}
-		glBindFramebuffer(GL_FRAMEBUFFER, 0); // 解绑 FBO，确保默认 FBO 激活
+		if (hadRecord) invalidate(shadowCasterRecords[i].worldMin, shadowCasterRecords[i].worldMax);
+		if (hasObject) invalidate(records[i].worldMin, records[i].worldMax);
+	}
+	shadowCasterRecords.swap(records);
+}
 
-		// 计算阴影矩阵
-		glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), (float)SHADOW_WIDTH / SHADOW_HEIGHT, 0.1f, light.far_plane);
-		light.shadowMatrices[0] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-		light.shadowMatrices[1] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-		light.shadowMatrices[2] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		light.shadowMatrices[3] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
-		light.shadowMatrices[4] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-		light.shadowMatrices[5] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+// 光源数据在分簇缓冲纹理里，这里只设置分簇参数、阴影图集和各光源在图集中的区域
+void setPointLightUniforms(Shader& shader)
+{
+	setLightClusterUniforms(shader, renderWidth, renderHeight);
+	shader.setInt("shadowAtlas", 10);
+	shader.setInt("shadowAtlasCompare", 11);
+	shader.setInt("shadowMoments", 12);
+	shader.setInt("shadowMask", SHADOW_MASK_TEXTURE_UNIT);
+	shader.setInt("shadowMaskDepth", SHADOW_MASK_DEPTH_TEXTURE_UNIT);
+	shader.setBool("useShadowMask", false);
+	shader.setFloat("shadowMomentTexel", 1.0f / SHADOW_MOMENT_SIZE);
+	shader.setInt("shadowFilterMode", shadowFilterMode);
+	shader.setInt("pcfTaps", useTAA ? TAA_PCF_TAPS : qualityGovernor.pcfTaps);
+	shader.setFloat("shadowNoiseOffset", useTAA ? temporalNoiseOffset() : 0.0f);
+	shader.setInt("pointShadowLayout", pointShadowLayout);
+	shader.setFloat("shadowAtlasTexel", 1.0f / SHADOW_ATLAS_SIZE);
+	for (const PointLight& light : pointLights)
+	{
+		if (light.shadowIndex < 0) continue;
+		for (int face = 0; face < 6; ++face)
+		{
+			// 区域换算成图集 uv：xy 左下角，z 边长（0 表示本帧没有阴影）
+			const ShadowAtlasRect& rect = light.atlasRects[face];
+			// 还没画过的面（刚分到新区域）先当作无阴影
+			int size = (light.validFaces & (1u << face)) ? rect.size : 0;
+			glm::vec4 uvRect = glm::vec4(rect.x, rect.y, size, 0.0f) / (float)SHADOW_ATLAS_SIZE;
+			shader.setVec4(("shadowAtlasRects[" + std::to_string(light.shadowIndex * 6 + face) + "]").c_str(), uvRect);
+		}
+	}
+}
+
+void initPointLights()
+{
+	int shadowCount = 0;
+	for (auto& light : pointLights)
+	{
+		light.shadowIndex = -1;
+		light.shadowResolution = 0;
+		light.requestedResolution = 0;
+		light.validFaces = 0;
+		for (int face = 0; face < 6; ++face) light.atlasRects[face] = ShadowAtlasRect();
+
+		// 只有前 MAX_SHADOWED_POINT_LIGHTS 个投射阴影的光源分配阴影槽位，面在阴影图集中的位置每帧由 updateShadowAtlas 决定
+		if (!light.castShadows || shadowCount >= (int)MAX_SHADOWED_POINT_LIGHTS) continue;
+		light.shadowIndex = shadowCount++;
+		updatePointLightShadowMatrices(light);
+		light.dirtyFaces = SHADOW_ALL_FACES;
+	}
+}
+
+// 按当前位置计算各面的阴影矩阵和剔除视锥；聚光灯只有第 0 面，张角等于锥角；四面体布局 4 个面
+// up 向量的选择与 pbr_lighting.glsl 的 spotFaceCoord 一致
+void updatePointLightShadowMatrices(PointLight& light)
+{
+	light.shadowOrigin = light.position;
+	light.shadowDirection = light.direction;
+	if (light.isSpot())
+	{
+		glm::vec3 up = glm::abs(light.direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 spotProj = glm::perspective(2.0f * glm::acos(light.cutOff), 1.0f, 0.1f, light.far_plane);
+		light.shadowMatrices[0] = spotProj * glm::lookAt(light.position, light.position + light.direction, up);
+		light.faceFrusta[0] = Frustum(light.shadowMatrices[0]);
+		return;
+	}
+	if (pointShadowLayout == POINT_SHADOW_TETRAHEDRAL)
+	{
+		const float nearPlane = 0.1f;
+		glm::mat4 tetraProj = glm::frustum(-TETRA_TAN_X * nearPlane, TETRA_TAN_X * nearPlane,
+			TETRA_TAN_BOTTOM * nearPlane, TETRA_TAN_TOP * nearPlane, nearPlane, light.far_plane);
+		for (int i = 0; i < 4; ++i)
+		{
+			light.shadowMatrices[i] = tetraProj * glm::lookAt(light.position, light.position + TETRA_FACE_NORMALS[i], TETRA_FACE_UPS[i]);
+			light.faceFrusta[i] = Frustum(light.shadowMatrices[i]);
+		}
+		return;
+	}
+
+	glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, light.far_plane);
+	light.shadowMatrices[0] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+	light.shadowMatrices[1] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+	light.shadowMatrices[2] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	light.shadowMatrices[3] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	light.shadowMatrices[4] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+	light.shadowMatrices[5] = shadowProj * glm::lookAt(light.position, light.position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		light.faceFrusta[i] = Frustum(light.shadowMatrices[i]);
 	}
 }
 
@@ -795,6 +1792,130 @@ void processInput(GLFWwindow* window)
 		camera.ProcessKeyboard(UP, deltaTime);
 	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
 		camera.ProcessKeyboard(DOWN, deltaTime);
+
+	// 渲染开关
+	if (keyPressedOnce(window, GLFW_KEY_F1))
+	{
+		useImpostors = !useImpostors;
+		std::cout << "Impostors: " << (useImpostors ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F2))
+	{
+		useWeightedOIT = !useWeightedOIT;
+		std::cout << "Transparency: " << (useWeightedOIT ? "weighted blended OIT" : "sorted") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F3))
+	{
+		useDepthPrepass = !useDepthPrepass;
+		std::cout << "Depth prepass: " << (useDepthPrepass ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F4))
+	{
+		useDeferred = !useDeferred;
+		std::cout << "Shading: " << (useDeferred ? "deferred" : "forward") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F5))
+	{
+		useShadowDepth16 = !useShadowDepth16; // 下一帧重新分配图集并重画全部阴影
+		std::cout << "Shadow atlas depth: " << (useShadowDepth16 ? "16-bit" : "32-bit float") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F6))
+	{
+		useShadowProxies = !useShadowProxies;
+		for (auto& light : pointLights) light.dirtyFaces = SHADOW_ALL_FACES;
+		std::cout << "Shadow casters: " << (useShadowProxies ? "simplified proxies" : "full meshes") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F7))
+	{
+		static const char* filterNames[] = { "point sampled, 20 taps", "hardware PCF, 4-8 taps", "moments, 1 filtered fetch" };
+		shadowFilterMode = (shadowFilterMode + 1) % 3;
+		if (shadowFilterMode == SHADOW_FILTER_MOMENTS)
+		{
+			// 矩只在阴影更新时生成，切换过来时矩图集里还没有内容
+			for (auto& light : pointLights)
+			{
+				light.dirtyFaces = SHADOW_ALL_FACES;
+				light.validFaces = 0;
+			}
+		}
+		std::cout << "Shadow filtering: " << filterNames[shadowFilterMode] << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F8))
+	{
+		useSunLight = !useSunLight;
+		std::cout << "Sun light: " << (useSunLight ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F9))
+	{
+		readingLampShadows = !readingLampShadows;
+		for (size_t i = readingLampFirst; i < pointLights.size(); ++i) pointLights[i].castShadows = readingLampShadows;
+		initPointLights(); // 重新分配阴影槽位，新光源的面由调度器分摊到后续几帧
+		std::cout << "Reading lamp shadows: " << (readingLampShadows ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F10))
+	{
+		pointShadowLayout = pointShadowLayout == POINT_SHADOW_CUBE ? POINT_SHADOW_TETRAHEDRAL : POINT_SHADOW_CUBE;
+		for (auto& light : pointLights)
+		{
+			if (light.shadowIndex < 0 || light.isSpot()) continue;
+			updatePointLightShadowMatrices(light); // 面数变化，图集下一帧重新打包
+			light.dirtyFaces = SHADOW_ALL_FACES;
+			light.validFaces = 0;
+		}
+		std::cout << "Point shadow layout: " << (pointShadowLayout == POINT_SHADOW_CUBE ? "cube, 6 faces" : "tetrahedral, 4 faces") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F11))
+	{
+		static const char* maskNames[] = { "OFF", "full resolution", "half resolution" };
+		shadowMaskMode = (shadowMaskMode + 1) % 3;
+		std::cout << "Screen-space shadow mask: " << maskNames[shadowMaskMode] << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_F12))
+	{
+		setQualityGovernorEnabled(!qualityGovernor.enabled);
+		std::cout << "Quality governor: " << (qualityGovernor.enabled ? "ON" : "OFF (full resolution, full quality)") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_T))
+	{
+		useTAA = !useTAA;
+		resetTemporalAA();
+		std::cout << "Temporal AA: " << (useTAA ? "ON (PCF 4 taps, POM 8 steps)" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_B))
+	{
+		postProcess.bloom = !postProcess.bloom;
+		std::cout << "Bloom: " << (postProcess.bloom ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_V))
+	{
+		renderGraph.dumpNextFrame = true;
+		std::cout << "Render graph: dumping next frame" << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_L))
+	{
+		lightProbeGrid.enabled = !lightProbeGrid.enabled;
+		std::cout << "Light probes: " << (lightProbeGrid.enabled ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_I))
+	{
+		lightmap.enabled = !lightmap.enabled;
+		std::cout << "Lightmap: " << (lightmap.enabled ? "ON" : "OFF") << std::endl;
+	}
+	if (keyPressedOnce(window, GLFW_KEY_C))
+	{
+		reflectionProbes.enabled = !reflectionProbes.enabled;
+		std::cout << "Reflection probes: " << (reflectionProbes.enabled ? "ON" : "OFF") << std::endl;
+	}
+}
+
+// 按键按下沿检测，按住不放只触发一次
+bool keyPressedOnce(GLFWwindow* window, int key)
+{
+	static std::map<int, bool> keyStates;
+	bool pressed = glfwGetKey(window, key) == GLFW_PRESS;
+	bool triggered = pressed && !keyStates[key];
+	keyStates[key] = pressed;
+	return triggered;
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)